@@ -0,0 +1,116 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __SPSC_RING_H__
+#define __SPSC_RING_H__
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+//-----------------------------------------------------------------------------
+// Single producer / single consumer ring
+//-----------------------------------------------------------------------------
+// The producer (radio) owns mHead, the consumer (app) owns mTail. Each side
+// publishes its index with release semantics and reads the other one with
+// acquire semantics, therefore no interrupt masking is required. The indices
+// run freely, the slot is selected with a mask (SIZE must be a power of two).
+// The main radio and the RX-only radios are several producers of one ring,
+// this is only safe because all of them push from the same loop context
+// (HmSystem::loop), none of them from an interrupt.
+template <class T, uint8_t SIZE>
+class SpscRing {
+    static_assert((SIZE > 0) && (0 == (SIZE & (SIZE - 1))), "SpscRing: SIZE must be a power of two");
+    static_assert(SIZE <= 128, "SpscRing: SIZE must fit the uint8_t fill level");
+
+    public:
+        SpscRing() {
+            clear();
+        }
+
+        // only allowed while producer and consumer are idle
+        void clear(void) {
+            mHead.store(0, std::memory_order_relaxed);
+            mTail.store(0, std::memory_order_relaxed);
+            mOverflow  = 0;
+            mHighWater = 0;
+        }
+
+        inline bool empty(void) const {
+            return (mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire));
+        }
+
+        inline bool full(void) const {
+            return (getFill() == SIZE);
+        }
+
+        inline uint8_t getFill(void) const {
+            return (uint8_t)(mHead.load(std::memory_order_acquire) - mTail.load(std::memory_order_acquire));
+        }
+
+        // producer: slot to write to, NULL if the ring is full (the dropped
+        // packet is counted as overflow)
+        T *getFront(void) {
+            uint32_t head = mHead.load(std::memory_order_relaxed);
+            if((head - mTail.load(std::memory_order_acquire)) == SIZE) {
+                mOverflow++;
+                return NULL;
+            }
+            return &mBuf[head & (SIZE - 1)];
+        }
+
+        // producer: publishes the slot returned by getFront
+        bool pushFront(T *record) {
+            uint32_t head = mHead.load(std::memory_order_relaxed);
+            uint8_t fill = (uint8_t)(head - mTail.load(std::memory_order_acquire));
+            if(fill == SIZE)
+                return false;
+            T *f = &mBuf[head & (SIZE - 1)];
+            if(f != record)
+                *f = *record;
+            mHead.store(head + 1, std::memory_order_release);
+            if(++fill > mHighWater)
+                mHighWater = fill;
+            return true;
+        }
+
+        // consumer: oldest slot, NULL if the ring is empty
+        T *getBack(void) {
+            uint32_t tail = mTail.load(std::memory_order_relaxed);
+            if(tail == mHead.load(std::memory_order_acquire))
+                return NULL;
+            return &mBuf[tail & (SIZE - 1)];
+        }
+
+        // consumer: releases the slot returned by getBack
+        bool popBack(void) {
+            uint32_t tail = mTail.load(std::memory_order_relaxed);
+            if(tail == mHead.load(std::memory_order_acquire))
+                return false;
+            mTail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        inline uint32_t getOverflowCnt(void) const {
+            return mOverflow;
+        }
+
+        inline uint8_t getHighWater(void) const {
+            return mHighWater;
+        }
+
+        inline uint8_t getSize(void) const {
+            return SIZE;
+        }
+
+    private:
+        T mBuf[SIZE];
+        std::atomic<uint32_t> mHead; // next slot to write (producer)
+        std::atomic<uint32_t> mTail; // next slot to read (consumer)
+        uint32_t mOverflow;          // producer only
+        uint8_t mHighWater;          // producer only
+};
+
+#endif /*__SPSC_RING_H__*/
@@ -81,19 +81,73 @@ void app::loop(void) {
         ESP.restart();
     }
 
-    mSys->Radio.loop();
+    mSys->loop();
 
     yield();
 
     if (checkTicker(&mRxTicker, 5)) {
         bool rxRdy = mSys->Radio.switchRxCh();
+        bool pyldRdy = false;
+
+        packet_t *p = mSys->BufCtrl.getBack();
+        if (NULL != p) {
+            uint8_t len, hdr[FRAGMENT_HDR_LEN];
+            uint8_t chIdx = getChIdx(p->rxCh);
+            chLinkStat_t *chLink = (0xff == chIdx) ? NULL : &mChLink[chIdx]; // unknown channel: not counted
+
+            len = mSys->Radio.getPacketHeader(p->packet, hdr);
+            Inverter<> *iv = mSys->findInverter(&hdr[1]);
+
+            if ((NULL != iv) && (hdr[0] == (TX_REQ_INFO + ALL_FRAMES))) {  // response from get information command
+                // the fragment is decoded straight to its place in the payload buffer
+                uint8_t pid = hdr[9];
+                if (pid == 0x00) {
+                    DPRINT(DBG_DEBUG, F("fragment number zero received and ignored"));
+                } else if (((pid & 0x7f) > MAX_PAYLOAD_ENTRIES) || (len > (FRAGMENT_HDR_LEN + 1 + MAX_FRAGMENT_LEN))) {
+                    DPRINTLN(DBG_WARN, F("fragment 0x") + String(pid, HEX) + F(" exceeds the payload buffer"));
+                } else if (0 == (mPayload[iv->id].rcvMask & (1 << ((pid & 0x7f) - 1)))) { // process fragment only on first occurrence
+                    uint8_t *dst = &mPayload[iv->id].data[((pid & 0x7f) - 1) * MAX_FRAGMENT_LEN];
+                    if (mSys->Radio.getFragment(p->packet, len, hdr, dst)) {
+                        if (mConfig.serialDebug) {
+                            DPRINT(DBG_INFO, "RX " + String(len) + "B Ch" + String(p->rxCh) + " | ");
+                            mSys->Radio.dumpBuf(NULL, hdr, FRAGMENT_HDR_LEN);
+                        }
+                        mStat.frmCnt++;
+                        mIvLink[iv->id].frmCnt++;
+                        if (NULL != chLink)
+                            chLink->frmCnt++;
+                        mPayload[iv->id].rcvMask |= (1 << ((pid & 0x7f) - 1));
+                        mSys->Radio.rxFragment(iv->radioId.u64, p->rxCh);
+
+                        mPayload[iv->id].txId = hdr[0];
+                        DPRINTLN(DBG_DEBUG, F("Response from info request received"));
+                        DPRINTLN(DBG_DEBUG, "PID: 0x" + String(pid, HEX));
+                        mPayload[iv->id].len[(pid & 0x7f) - 1] = len - FRAGMENT_HDR_LEN - 1;
+
+                        if ((pid & ALL_FRAMES) == ALL_FRAMES) {
+                            // Last packet
+                            if ((pid & 0x7f) > mPayload[iv->id].maxPackId) {
+                                mPayload[iv->id].maxPackId = (pid & 0x7f);
+                                if (pid > 0x81)
+                                    mPayload[iv->id].lastPacketId = pid;
+                            }
+                        }
 
-        if (!mSys->BufCtrl.empty()) {
-            uint8_t len;
-            packet_t *p = mSys->BufCtrl.getBack();
-
-            if (mSys->Radio.checkPaketCrc(p->packet, &len, p->rxCh)) {
-                // process buffer only on first occurrence
+                        // all fragments up to the last frame are in, decode without waiting
+                        if ((0 != mPayload[iv->id].maxPackId) && (mPayload[iv->id].rcvMask == ((1 << mPayload[iv->id].maxPackId) - 1)))
+                            pyldRdy = true;
+                    } else {
+                        mIvLink[iv->id].crcFail++;
+                        if (NULL != chLink)
+                            chLink->crcFail++;
+                    }
+                } else {
+                    mIvLink[iv->id].dupCnt++;
+                    if (NULL != chLink)
+                        chLink->dupCnt++;
+                }
+            }
+            else if (mSys->Radio.checkPaketCrc(p->packet, &len, p->rxCh)) {
                 if (mConfig.serialDebug) {
                     DPRINT(DBG_INFO, "RX " + String(len) + "B Ch" + String(p->rxCh) + " | ");
                     mSys->Radio.dumpBuf(NULL, p->packet, len);
@@ -102,30 +156,6 @@ void app::loop(void) {
                 mStat.frmCnt++;
 
                 if (0 != len) {
-                    Inverter<> *iv = mSys->findInverter(&p->packet[1]);
-                    if ((NULL != iv) && (p->packet[0] == (TX_REQ_INFO + ALL_FRAMES))) {  // response from get information command
-                        mPayload[iv->id].txId = p->packet[0];
-                        DPRINTLN(DBG_DEBUG, F("Response from info request received"));
-                        uint8_t *pid = &p->packet[9];
-                        if (*pid == 0x00) {
-                            DPRINT(DBG_DEBUG, F("fragment number zero received and ignored"));
-                        } else {
-                            DPRINTLN(DBG_DEBUG, "PID: 0x" + String(*pid, HEX));
-                            if ((*pid & 0x7F) < 5) {
-                                memcpy(mPayload[iv->id].data[(*pid & 0x7F) - 1], &p->packet[10], len - 11);
-                                mPayload[iv->id].len[(*pid & 0x7F) - 1] = len - 11;
-                            }
-
-                            if ((*pid & ALL_FRAMES) == ALL_FRAMES) {
-                                // Last packet
-                                if ((*pid & 0x7f) > mPayload[iv->id].maxPackId) {
-                                    mPayload[iv->id].maxPackId = (*pid & 0x7f);
-                                    if (*pid > 0x81)
-                                        mLastPacketId = *pid;
-                                }
-                            }
-                        }
-                    }
                     if ((NULL != iv) && (p->packet[0] == (TX_REQ_DEVCONTROL + ALL_FRAMES))) { // response from dev control command
                         DPRINTLN(DBG_DEBUG, F("Response from devcontrol request received"));
 
@@ -137,15 +167,24 @@ void app::loop(void) {
                             DPRINTLN(DBG_INFO, F("Inverter ") + String(iv->id) + F(" has ") + msg + F("accepted power limit set point ") + String(iv->powerLimit[0]) + F(" with PowerLimitControl ") + String(iv->powerLimit[1]));
                         }
                         iv->devControlCmd = Init;
+                        pyldRdy = true;
                     }
                 }
             }
+            else if (NULL != chLink)
+                chLink->crcFail++;
             mSys->BufCtrl.popBack();
         }
         yield();
 
-        if (rxRdy) {
-            processPayload(true);
+        if (rxRdy || pyldRdy) {
+            processPayload(rxRdy);
+
+            // replace finished requests by the next inverters of the round,
+            // stop listening once nothing is outstanding
+            fillPollPipeline();
+            if (0 == getPollingCnt())
+                mSys->Radio.closeRxWindow();
         }
     }
 
@@ -153,6 +192,9 @@ void app::loop(void) {
         mMqtt.loop();
 
     if (checkTicker(&mTicker, 1000)) {
+        if (mMqttActive)
+            sendOutbox();
+
         if (mUtcTimestamp > 946684800 && mConfig.sunLat && mConfig.sunLon && (mUtcTimestamp + mCalculatedTimezoneOffset) / 86400 != (mLatestSunTimestamp + mCalculatedTimezoneOffset) / 86400) {  // update on reboot or midnight
             if (!mLatestSunTimestamp) {                                                                                                                                                           // first call: calculate time zone from longitude to refresh at local midnight
                 mCalculatedTimezoneOffset = (int8_t)((mConfig.sunLon >= 0 ? mConfig.sunLon + 7.5 : mConfig.sunLon - 7.5) / 15) * 3600;
@@ -169,18 +211,19 @@ void app::loop(void) {
         if (mConfig.serialShowIv) {
             if (++mSerialTicker >= mConfig.serialInterval) {
                 mSerialTicker = 0;
-                char topic[30], val[10];
+                char topic[30], val[16];
                 for (uint8_t id = 0; id < mSys->getNumInverters(); id++) {
                     Inverter<> *iv = mSys->getInverterByPos(id);
                     if (NULL != iv) {
                         record_t<> *rec = iv->getRecordStruct(RealTimeRunData_Debug);
-                        if (iv->isAvailable(mUtcTimestamp, rec)) {
+                        uint64_t changed = iv->getChanges(rec, REC_CONS_SERIAL);
+                        if (iv->isAvailable(mUtcTimestamp, rec) && (0 != changed)) {
                             DPRINTLN(DBG_INFO, "Inverter: " + String(id));
                             for (uint8_t i = 0; i < rec->length; i++) {
-                                if (0.0f != iv->getValue(i, rec)) {
+                                if (changed & (1ULL << i)) {
                                     snprintf(topic, 30, "%s/ch%d/%s", iv->name, rec->assign[i].ch, iv->getFieldName(i, rec));
-                                    snprintf(val, 10, "%.3f %s", iv->getValue(i, rec), iv->getUnit(i, rec));
-                                    DPRINTLN(DBG_INFO, String(topic) + ": " + String(val));
+                                    iv->getValueStr(i, rec, val, 16);
+                                    DPRINTLN(DBG_INFO, String(topic) + ": " + String(val) + " " + String(iv->getUnit(i, rec)));
                                 }
                                 yield();
                             }
@@ -203,62 +246,104 @@ void app::loop(void) {
                         DPRINTLN(DBG_DEBUG, F("recbuf not empty! #") + String(mSys->BufCtrl.getFill()));
                 }
 
-                int8_t maxLoop = MAX_NUM_INVERTERS;
-                Inverter<> *iv = mSys->getInverterByPos(mSendLastIvId);
-                do {
-                    // if(NULL != iv)
-                    //     mPayload[iv->id].requested = false;
-                    mSendLastIvId = ((MAX_NUM_INVERTERS - 1) == mSendLastIvId) ? 0 : mSendLastIvId + 1;
-                    iv = mSys->getInverterByPos(mSendLastIvId);
-                } while ((NULL == iv) && ((maxLoop--) > 0));
+                // a poll round requests all inverters, up to POLL_PIPELINE_DEPTH
+                // of them are outstanding at the same time, the next one is
+                // requested as soon as one of them is finished
+                mStat.spiBytes = mSys->Radio.getSpiBytes(true); // of the previous round
+                mPollRemaining = mIvCnt;
+                fillPollPipeline();
+            } else if (mConfig.serialDebug)
+                DPRINTLN(DBG_WARN, F("Time not set or it is night time, therefore no communication to the inverter!"));
+            yield();
+        }
+    }
+}
 
-                if (NULL != iv) {
-                    if (!mPayload[iv->id].complete)
-                        processPayload(false);
+//-----------------------------------------------------------------------------
+void app::pollNextInverter(void) {
+    DPRINTLN(DBG_VERBOSE, F("app::pollNextInverter"));
+    Inverter<> *iv = NULL;
+    while ((NULL == iv) && (0 != mPollRemaining)) {
+        mPollRemaining--;
+        mSendLastIvId = ((mSendLastIvId + 1) >= mIvCnt) ? 0 : mSendLastIvId + 1;
+        iv = mSys->getInverterByPos(mSendLastIvId);
+    }
+    if (NULL == iv)
+        return; // poll round finished
+
+    if (!mPayload[iv->id].complete)
+        processPayload(false);
+
+    if (!mPayload[iv->id].complete) {
+        uint8_t missing = 1;
+        if (0 == mPayload[iv->id].maxPackId)
+            mStat.rxFailNoAnser++;
+        else {
+            mStat.rxFail++;
+            uint16_t all = (1 << mPayload[iv->id].maxPackId) - 1;
+            missing = __builtin_popcount(all & ~mPayload[iv->id].rcvMask);
+        }
+        mIvLink[iv->id].missing += missing;
+        mSys->Radio.lostFragments(iv->radioId.u64, missing);
+
+        iv->setQueuedCmdFinished();  // command failed
+        if (mConfig.serialDebug)
+            DPRINTLN(DBG_INFO, F("enqueued cmd failed/timeout"));
+        if (mConfig.serialDebug) {
+            DPRINT(DBG_INFO, F("Inverter #") + String(iv->id) + " ");
+            DPRINTLN(DBG_INFO, F("no Payload received! (retransmits: ") + String(mPayload[iv->id].retransmits) + ")");
+        }
+    }
 
-                    if (!mPayload[iv->id].complete) {
-                        if (0 == mPayload[iv->id].maxPackId)
-                            mStat.rxFailNoAnser++;
-                        else
-                            mStat.rxFail++;
+    resetPayload(iv);
+    mPayload[iv->id].requested = true;
+    mPayload[iv->id].polling = true;
+    mIvLink[iv->id].reqMillis = millis();
 
-                        iv->setQueuedCmdFinished();  // command failed
-                        if (mConfig.serialDebug)
-                            DPRINTLN(DBG_INFO, F("enqueued cmd failed/timeout"));
-                        if (mConfig.serialDebug) {
-                            DPRINT(DBG_INFO, F("Inverter #") + String(iv->id) + " ");
-                            DPRINTLN(DBG_INFO, F("no Payload received! (retransmits: ") + String(mPayload[iv->id].retransmits) + ")");
-                        }
-                    }
+    yield();
+    if (mConfig.serialDebug) {
+        DPRINTLN(DBG_DEBUG, F("app:loop WiFi WiFi.status ") + String(WiFi.status()));
+        DPRINTLN(DBG_INFO, F("Requesting Inverter SN ") + String(iv->serial.u64, HEX));
+    }
 
-                    resetPayload(iv);
-                    mPayload[iv->id].requested = true;
+    if (iv->devControlRequest) {
+        if (mConfig.serialDebug)
+            DPRINTLN(DBG_INFO, F("Devcontrol request ") + String(iv->devControlCmd) + F(" power limit ") + String(iv->powerLimit[0]));
+        mSys->Radio.sendControlPacket(iv->radioId.u64, iv->devControlCmd, iv->powerLimit);
+        mPayload[iv->id].txCmd = iv->devControlCmd;
+        iv->clearCmdQueue();
+        iv->enqueCommand<InfoCommand>(SystemConfigPara);
+    } else {
+        uint8_t cmd = iv->getQueuedCmd();
+        mSys->Radio.sendTimePacket(iv->radioId.u64, cmd, mPayload[iv->id].ts, iv->alarmMesIndex);
+        mPayload[iv->id].txCmd = cmd;
+        mRxTicker = 0;
+    }
+}
 
-                    yield();
-                    if (mConfig.serialDebug) {
-                        DPRINTLN(DBG_DEBUG, F("app:loop WiFi WiFi.status ") + String(WiFi.status()));
-                        DPRINTLN(DBG_INFO, F("Requesting Inverter SN ") + String(iv->serial.u64, HEX));
-                    }
+//-----------------------------------------------------------------------------
+void app::fillPollPipeline(void) {
+    while ((0 != mPollRemaining) && (getPollingCnt() < POLL_PIPELINE_DEPTH))
+        pollNextInverter();
+}
 
-                    if (iv->devControlRequest) {
-                        if (mConfig.serialDebug)
-                            DPRINTLN(DBG_INFO, F("Devcontrol request ") + String(iv->devControlCmd) + F(" power limit ") + String(iv->powerLimit[0]));
-                        mSys->Radio.sendControlPacket(iv->radioId.u64, iv->devControlCmd, iv->powerLimit);
-                        mPayload[iv->id].txCmd = iv->devControlCmd;
-                        iv->clearCmdQueue();
-                        iv->enqueCommand<InfoCommand>(SystemConfigPara);
-                    } else {
-                        uint8_t cmd = iv->getQueuedCmd();
-                        mSys->Radio.sendTimePacket(iv->radioId.u64, cmd, mPayload[iv->id].ts, iv->alarmMesIndex);
-                        mPayload[iv->id].txCmd = cmd;
-                        mRxTicker = 0;
-                    }
-                }
-            } else if (mConfig.serialDebug)
-                DPRINTLN(DBG_WARN, F("Time not set or it is night time, therefore no communication to the inverter!"));
-            yield();
-        }
+//-----------------------------------------------------------------------------
+uint8_t app::getPollingCnt(void) {
+    uint8_t cnt = 0;
+    for (uint8_t i = 0; i < mIvCnt; i++) {
+        if (mPayload[i].polling)
+            cnt++;
+    }
+    return cnt;
+}
+
+//-----------------------------------------------------------------------------
+uint8_t app::getChIdx(uint8_t rxCh) {
+    for (uint8_t i = 0; i < RF_CHANNELS; i++) {
+        if (mSys->Radio.getRfChannel(i) == rxCh)
+            return i;
     }
+    return 0xff;
 }
 
 //-----------------------------------------------------------------------------
@@ -273,21 +358,31 @@ bool app::buildPayload(uint8_t id) {
     uint16_t crc = 0xffff, crcRcv = 0x0000;
     if (mPayload[id].maxPackId > MAX_PAYLOAD_ENTRIES)
         mPayload[id].maxPackId = MAX_PAYLOAD_ENTRIES;
+    if (0 == mPayload[id].maxPackId)
+        return false;
 
-    for (uint8_t i = 0; i < mPayload[id].maxPackId; i++) {
-        if (mPayload[id].len[i] > 0) {
-            if (i == (mPayload[id].maxPackId - 1)) {
-                crc = ah::crc16(mPayload[id].data[i], mPayload[id].len[i] - 2, crc);
-                crcRcv = (mPayload[id].data[i][mPayload[id].len[i] - 2] << 8) | (mPayload[id].data[i][mPayload[id].len[i] - 1]);
-            } else
-                crc = ah::crc16(mPayload[id].data[i], mPayload[id].len[i], crc);
-        }
-        yield();
+    // the fragments are placed next to each other, all but the last must be full
+    for (uint8_t i = 0; i < (mPayload[id].maxPackId - 1); i++) {
+        if (mPayload[id].len[i] != MAX_FRAGMENT_LEN)
+            return false;
     }
+    uint8_t len = getPayloadLen(id) + 2;
+    if (len < 3)
+        return false;
+
+    crc = ah::crc16(mPayload[id].data, len - 2, crc);
+    crcRcv = (mPayload[id].data[len - 2] << 8) | (mPayload[id].data[len - 1]);
 
     return (crc == crcRcv) ? true : false;
 }
 
+//-----------------------------------------------------------------------------
+uint8_t app::getPayloadLen(uint8_t id) {
+    // payload length without the trailing crc16
+    uint8_t last = mPayload[id].maxPackId - 1;
+    return (last * MAX_FRAGMENT_LEN) + mPayload[id].len[last] - 2;
+}
+
 //-----------------------------------------------------------------------------
 void app::processPayload(bool retransmit) {
     for (uint8_t id = 0; id < mSys->getNumInverters(); id++) {
@@ -308,31 +403,16 @@ void app::processPayload(bool retransmit) {
                         // This is required to prevent retransmissions without answer.
                         DPRINTLN(DBG_INFO, F("Prevent retransmit on Restart / CleanState_LockAndAlarm..."));
                         mPayload[iv->id].retransmits = mConfig.maxRetransPerPyld;
+                        mPayload[iv->id].polling = false;
                     } else {
                         if (mPayload[iv->id].retransmits < mConfig.maxRetransPerPyld) {
                             mPayload[iv->id].retransmits++;
-                            if (mPayload[iv->id].maxPackId != 0) {
-                                for (uint8_t i = 0; i < (mPayload[iv->id].maxPackId - 1); i++) {
-                                    if (mPayload[iv->id].len[i] == 0) {
-                                        if (mConfig.serialDebug)
-                                            DPRINTLN(DBG_WARN, F("while retrieving data: Frame ") + String(i + 1) + F(" missing: Request Retransmit"));
-                                        mSys->Radio.sendCmdPacket(iv->radioId.u64, TX_REQ_INFO, (SINGLE_FRAME + i), true);
-                                        break;  // only retransmit one frame per loop
-                                    }
-                                    yield();
-                                }
-                            } else {
-                                if (mConfig.serialDebug)
-                                    DPRINTLN(DBG_WARN, F("while retrieving data: last frame missing: Request Retransmit"));
-                                if (0x00 != mLastPacketId)
-                                    mSys->Radio.sendCmdPacket(iv->radioId.u64, TX_REQ_INFO, mLastPacketId, true);
-                                else {
-                                    mPayload[iv->id].txCmd = iv->getQueuedCmd();
-                                    mSys->Radio.sendTimePacket(iv->radioId.u64, mPayload[iv->id].txCmd, mPayload[iv->id].ts, iv->alarmMesIndex);
-                                }
-                            }
+                            mIvLink[iv->id].retransmits++;
+                            requestRetransmit(iv);
                             mSys->Radio.switchRxCh(100);
                         }
+                        else
+                            mPayload[iv->id].polling = false; // give up
                     }
                 }
             } else {  // payload complete
@@ -342,17 +422,12 @@ void app::processPayload(bool retransmit) {
                 record_t<> *rec = iv->getRecordStruct(mPayload[iv->id].txCmd);  // choose the parser
                 mPayload[iv->id].complete = true;
 
-                uint8_t payload[128];
-                uint8_t payloadLen = 0;
+                ivLinkStat_t *link = &mIvLink[iv->id];
+                link->rtt = millis() - link->reqMillis;
+                link->rttAvg = (0 == link->rttAvg) ? link->rtt : ((link->rttAvg * 7 + link->rtt) >> 3);
 
-                memset(payload, 0, 128);
-
-                for (uint8_t i = 0; i < (mPayload[iv->id].maxPackId); i++) {
-                    memcpy(&payload[payloadLen], mPayload[iv->id].data[i], (mPayload[iv->id].len[i]));
-                    payloadLen += (mPayload[iv->id].len[i]);
-                    yield();
-                }
-                payloadLen -= 2;
+                uint8_t *payload = mPayload[iv->id].data; // decoded in place
+                uint8_t payloadLen = getPayloadLen(iv->id);
 
                 if (mConfig.serialDebug) {
                     DPRINT(DBG_INFO, F("Payload (") + String(payloadLen) + "): ");
@@ -365,12 +440,16 @@ void app::processPayload(bool retransmit) {
                     if (mPayload[iv->id].txId == (TX_REQ_INFO + 0x80))
                         mStat.rxSuccess++;
 
+                    iv->beginUpdate(rec);
                     rec->ts = mPayload[iv->id].ts;
-                    for (uint8_t i = 0; i < rec->length; i++) {
-                        iv->addValue(i, payload, rec);
-                        yield();
+                    iv->addValues(payload, rec);
+                    if (RealTimeRunData_Debug == mPayload[iv->id].txCmd)
+                        iv->doCalculations();
+                    iv->endUpdate(rec);
+                    if (RealTimeRunData_Debug == mPayload[iv->id].txCmd) {
+                        addHistory(iv, rec);
+                        addOutbox(iv, rec);
                     }
-                    iv->doCalculations();
 
                     mMqttSendList.push(mPayload[iv->id].txCmd);
                 } else {
@@ -382,6 +461,9 @@ void app::processPayload(bool retransmit) {
             }
         }
 
+        if (mPayload[iv->id].complete)
+            mPayload[iv->id].polling = false;
+
         yield();
 
     }
@@ -394,6 +476,45 @@ void app::processPayload(bool retransmit) {
     }
 }
 
+//-----------------------------------------------------------------------------
+void app::requestRetransmit(Inverter<> *iv) {
+    // all missing fragments are requested in one burst, one burst counts as
+    // one retransmit of the payload
+    invPayload_t *pyld = &mPayload[iv->id];
+
+    if (0 == pyld->rcvMask) { // nothing received, the request got lost
+        if (mConfig.serialDebug)
+            DPRINTLN(DBG_WARN, F("while retrieving data: no frame received: Request Retransmit"));
+        pyld->txCmd = iv->getQueuedCmd();
+        mSys->Radio.sendTimePacket(iv->radioId.u64, pyld->txCmd, pyld->ts, iv->alarmMesIndex);
+        return;
+    }
+
+    uint8_t last = pyld->maxPackId;
+    if (0 == last) { // tail missing, the last frame is known from previous payloads only
+        if (0x00 == pyld->lastPacketId) {
+            if (mConfig.serialDebug)
+                DPRINTLN(DBG_WARN, F("while retrieving data: last frame missing: Request Retransmit"));
+            pyld->txCmd = iv->getQueuedCmd();
+            mSys->Radio.sendTimePacket(iv->radioId.u64, pyld->txCmd, pyld->ts, iv->alarmMesIndex);
+            return;
+        }
+        last = pyld->lastPacketId & 0x7f;
+    }
+
+    // the middle fragments, the last one is requested with its own id
+    uint16_t missing = ~pyld->rcvMask & ((1 << (last - 1)) - 1);
+    if (mConfig.serialDebug)
+        DPRINTLN(DBG_WARN, F("while retrieving data: missing frames 0x") + String(missing, HEX) + ((0 == pyld->maxPackId) ? F(" + last") : F("")) + F(": Request Retransmit"));
+    for (uint8_t i = 0; i < (last - 1); i++) {
+        if (missing & (1 << i))
+            mSys->Radio.sendCmdPacket(iv->radioId.u64, TX_REQ_INFO, (SINGLE_FRAME + i), true);
+    }
+    if (0 == pyld->maxPackId)
+        mSys->Radio.sendCmdPacket(iv->radioId.u64, TX_REQ_INFO, pyld->lastPacketId, true);
+    yield();
+}
+
 //-----------------------------------------------------------------------------
 void app::cbMqtt(char *topic, byte *payload, unsigned int length) {
     // callback handling on subscribed devcontrol topic
@@ -517,7 +638,10 @@ void app::getAvailNetworks(JsonObject obj) {
 void app::sendMqttDiscoveryConfig(void) {
     DPRINTLN(DBG_VERBOSE, F("app::sendMqttDiscoveryConfig"));
 
-    char stateTopic[64], discoveryTopic[64], buffer[512], name[32], uniq_id[32];
+    char stateTopic[MQTT_TOPIC_MAX], discoveryTopic[MQTT_TOPIC_MAX], buffer[512], name[32], uniq_id[32];
+#if defined(MQTT_AGGREGATED)
+    char valTpl[48];
+#endif
     for (uint8_t id = 0; id < mSys->getNumInverters(); id++) {
         Inverter<> *iv = mSys->getInverterByPos(id);
         if (NULL != iv) {
@@ -537,14 +661,22 @@ void app::sendMqttDiscoveryConfig(void) {
                 } else {
                     snprintf(name, 32, "%s CH%d %s", iv->name, rec->assign[i].ch, iv->getFieldName(i, rec));
                 }
-                snprintf(stateTopic, 64, "%s/%s/ch%d/%s", mConfig.mqtt.topic, iv->name, rec->assign[i].ch, iv->getFieldName(i, rec));
-                snprintf(discoveryTopic, 64, "%s/sensor/%s/ch%d_%s/config", MQTT_DISCOVERY_PREFIX, iv->name, rec->assign[i].ch, iv->getFieldName(i, rec));
+#if defined(MQTT_AGGREGATED)
+                getIvTopic(stateTopic, iv, NULL, getRecName(RealTimeRunData_Debug));
+                snprintf(valTpl, 48, "{{ value_json['ch%d_%s'] }}", rec->assign[i].ch, iv->getFieldName(i, rec));
+#else
+                getIvTopic(stateTopic, iv, mqttChTopics[rec->assign[i].ch], iv->getFieldName(i, rec));
+#endif
+                snprintf(discoveryTopic, MQTT_TOPIC_MAX, "%s/sensor/%s/ch%d_%s/config", MQTT_DISCOVERY_PREFIX, iv->name, rec->assign[i].ch, iv->getFieldName(i, rec));
                 snprintf(uniq_id, 32, "ch%d_%s", rec->assign[i].ch, iv->getFieldName(i, rec));
                 const char *devCls = getFieldDeviceClass(rec->assign[i].fieldId);
                 const char *stateCls = getFieldStateClass(rec->assign[i].fieldId);
 
                 doc["name"] = name;
                 doc["stat_t"] = stateTopic;
+#if defined(MQTT_AGGREGATED)
+                doc["val_tpl"] = valTpl;
+#endif
                 doc["unit_of_meas"] = iv->getUnit(i, rec);
                 doc["uniq_id"] = String(iv->serial.u64, HEX) + "_" + uniq_id;
                 doc["dev"] = deviceObj;
@@ -560,24 +692,150 @@ void app::sendMqttDiscoveryConfig(void) {
                 doc.clear();
             }
 
-            // TODO: remove this field, obsolete?
-            mMqttConfigSendState[id] = true;
-
             yield();
         }
     }
 }
 
+//-----------------------------------------------------------------------------
+void app::sendMqttLinkStat(void) {
+    // only the values which changed are sent, all of them every MQTT_MAX_AGE
+    if (!mMqtt.isConnected())
+        return;
+    bool all = (0 == mLinkPubTs) || ((mUptimeSecs - mLinkPubTs) >= MQTT_MAX_AGE);
+    if (all)
+        mLinkPubTs = (0 == mUptimeSecs) ? 1 : mUptimeSecs;
+
+    char topic[MQTT_TOPIC_MAX], val[16];
+    for (uint8_t id = 0; id < mSys->getNumInverters(); id++) {
+        Inverter<> *iv = mSys->getInverterByPos(id);
+        if (NULL == iv)
+            continue; // skip to next inverter
+        ivLinkStat_t *link = &mIvLink[iv->id];
+        const char *names[] = {"frames", "crc_fail", "dup", "missing", "retransmits", "rtt"};
+        uint32_t vals[] = {link->frmCnt, link->crcFail, link->dupCnt, link->missing, link->retransmits, link->rttAvg};
+        for (uint8_t i = 0; i < 6; i++) {
+            if (!all && (vals[i] == link->pubVal[i]))
+                continue;
+            snprintf(val, 16, "%u", vals[i]);
+            if (getIvTopic(topic, iv, "link/", names[i]) && mMqtt.sendTopic(topic, val))
+                link->pubVal[i] = vals[i];
+        }
+        yield();
+    }
+
+    for (uint8_t i = 0; i < RF_CHANNELS; i++) {
+        uint32_t rpd, samples;
+        mSys->Radio.getRpd(i, &rpd, &samples);
+        uint8_t ch = mSys->Radio.getRfChannel(i);
+        chLinkStat_t *link = &mChLink[i];
+        const char *names[] = {"frames", "crc_fail", "rpd"};
+        uint32_t vals[] = {link->frmCnt, link->crcFail, (0 == samples) ? 0 : (uint32_t)((100ULL * rpd) / samples)};
+        for (uint8_t j = 0; j < 3; j++) {
+            if (!all && (vals[j] == link->pubVal[j]))
+                continue;
+            snprintf(topic, MQTT_TOPIC_MAX, "link/ch%02d/%s", ch, names[j]);
+            snprintf(val, 16, "%u", vals[j]);
+            if (mMqtt.sendMsg(topic, val))
+                link->pubVal[j] = vals[j];
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void app::addHistory(Inverter<> *iv, record_t<> *rec) {
+#if (HISTORY_SIZE > 0)
+    // a sample is only added if the value changed, it is valid until the next one
+    uint64_t changed = iv->getChanges(rec, REC_CONS_HISTORY);
+    for (uint8_t i = 0; i < HISTORY_FLD_CNT; i++) {
+        uint8_t pos = iv->getPosByChFld(CH0, historyFields[i], rec);
+        if ((0xff != pos) && (changed & (1ULL << pos)))
+            mHistory[iv->id][i].add(rec->ts, iv->getValueScaled(pos, rec));
+    }
+#endif
+}
+
+//-----------------------------------------------------------------------------
+void app::addOutbox(Inverter<> *iv, record_t<> *rec) {
+#if (MQTT_OUTBOX_SIZE > 0)
+    // kept only while the values can't be published
+    if (!mMqttActive || mMqtt.isConnected())
+        return;
+    outboxEntry_t e;
+    memset(&e, 0, sizeof(outboxEntry_t));
+    e.ts = rec->ts;
+    e.id = iv->id;
+    for (uint8_t i = 0; i < OUTBOX_FLD_CNT; i++) {
+        uint8_t pos = iv->getPosByChFld(CH0, outboxFields[i], rec);
+        if (0xff != pos)
+            e.val[i] = iv->getValueScaled(pos, rec);
+    }
+    mOutbox.add(&e);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+void app::sendOutbox(void) {
+#if (MQTT_OUTBOX_SIZE > 0)
+    char topic[MQTT_TOPIC_MAX], doc[64 + OUTBOX_FLD_CNT * 32], val[16];
+    outboxEntry_t e;
+    for (uint8_t n = 0; (n < MQTT_OUTBOX_RATE) && mMqtt.isConnected(); n++) {
+        if (!mOutbox.peek(&e))
+            break;
+        Inverter<> *iv = mSys->getInverterByPos(e.id);
+        if (NULL != iv) {
+            record_t<> *rec = iv->getRecordStruct(RealTimeRunData_Debug);
+            uint16_t len = snprintf(doc, sizeof(doc), "{\"ts\":%u", e.ts);
+            for (uint8_t i = 0; i < OUTBOX_FLD_CNT; i++) {
+                uint8_t pos = iv->getPosByChFld(CH0, outboxFields[i], rec);
+                if (0xff == pos)
+                    continue;
+                fmtRecVal(val, 16, e.val[i], iv->getScale(pos, rec));
+                len += snprintf(&doc[len], sizeof(doc) - len, ",\"%s\":%s", fields[outboxFields[i]], val);
+            }
+            snprintf(&doc[len], sizeof(doc) - len, "}");
+            getIvTopic(topic, iv, NULL, "backfill");
+            if (!mMqtt.sendTopic(topic, doc))
+                break; // again with the next call
+        }
+        mOutbox.pop();
+    }
+#endif
+}
+
 //-----------------------------------------------------------------------------
 void app::sendMqtt(void) {
-    mMqtt.isConnected(true);  // really needed? See comment from HorstG-57 #176
-    char topic[32 + MAX_NAME_LENGTH], val[32];
-    float total[4];
+    char topic[MQTT_TOPIC_MAX], val[32];
+#if defined(MQTT_AGGREGATED)
+    char doc[MQTT_MAX_PACKET_SIZE];
+#endif
+    recVal_t total[4];
+    uint16_t totalDiv[4];
     bool sendTotal = false;
-    memset(total, 0, sizeof(float) * 4);
+    memset(total, 0, sizeof(recVal_t) * 4);
+    memset(totalDiv, 0, sizeof(uint16_t) * 4);
     snprintf(val, 32, "%ld", millis() / 1000);
 
     mMqtt.sendMsg("uptime", val);
+    sendMqttLinkStat();
+
+    // records which weren't published for MQTT_MAX_AGE are sent again
+    // without a new payload, e.g. once an inverter stopped answering
+    uint8_t stale = 0;
+    for (uint8_t id = 0; id < mSys->getNumInverters(); id++) {
+        Inverter<> *iv = mSys->getInverterByPos(id);
+        if (NULL == iv)
+            continue;
+        mqttPubState_t *pub = &mMqttPub[iv->id];
+        for (uint8_t i = 0; i < 4; i++) {
+            if ((pub->sent & (1 << i)) && ((mUptimeSecs - pub->ts[i]) >= MQTT_MAX_AGE))
+                stale |= (1 << i);
+        }
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        if (stale & (1 << i))
+            mMqttSendList.push(mqttRecCmds[i]);
+    }
 
     if(mMqttSendList.empty())
         return;
@@ -588,62 +846,103 @@ void app::sendMqtt(void) {
             if (NULL == iv)
                 continue; // skip to next inverter
 
+            // only the values which changed enough or are too old are sent
             record_t<> *rec = iv->getRecordStruct(mMqttSendList.front());
-
-            if(mMqttSendList.front() == RealTimeRunData_Debug) {
-                // inverter status
-                uint8_t status = MQTT_STATUS_AVAIL_PROD;
+            uint64_t changed = getMqttPubMask(iv, rec, mMqttSendList.front());
+            bool isLive = (mMqttSendList.front() == RealTimeRunData_Debug);
+            mqttPubState_t *pub = &mMqttPub[iv->id];
+
+            // inverter status
+            uint8_t status = MQTT_STATUS_NOT_AVAIL_NOT_PROD;
+            if (isLive) {
+                status = MQTT_STATUS_AVAIL_PROD;
                 if (!iv->isAvailable(mUtcTimestamp, rec))
                     status = MQTT_STATUS_NOT_AVAIL_NOT_PROD;
                 if (!iv->isProducing(mUtcTimestamp, rec)) {
                     if (MQTT_STATUS_AVAIL_PROD == status)
                         status = MQTT_STATUS_AVAIL_NOT_PROD;
                 }
-                snprintf(topic, 32 + MAX_NAME_LENGTH, "%s/available_text", iv->name);
+            }
+
+#if defined(MQTT_AGGREGATED)
+            // all values of the record in one document, the live record
+            // carries the status and is also sent if the status changed
+            if ((0 != changed) || (isLive && (status != pub->status))) {
+                uint16_t len = snprintf(doc, MQTT_MAX_PACKET_SIZE, "{\"ts\":%u", iv->getLastTs(rec));
+                if (isLive)
+                    len += snprintf(&doc[len], MQTT_MAX_PACKET_SIZE - len, ",\"available\":%d", status);
+                for (uint8_t i = 0; (i < rec->length) && (len < MQTT_MAX_PACKET_SIZE); i++) {
+                    iv->getValueStr(i, rec, val, 32);
+                    len += snprintf(&doc[len], MQTT_MAX_PACKET_SIZE - len, ",\"ch%d_%s\":%s", rec->assign[i].ch, fields[rec->assign[i].fieldId], val);
+                }
+                if (len < (MQTT_MAX_PACKET_SIZE - 1)) {
+                    doc[len++] = '}';
+                    doc[len] = '\0';
+                    if (getIvTopic(topic, iv, NULL, getRecName(mMqttSendList.front())))
+                        mMqtt.sendTopic(topic, doc);
+                }
+                else
+                    DPRINTLN(DBG_WARN, F("MQTT_MAX_PACKET_SIZE too small for ") + String(iv->name));
+            }
+#else
+            if (isLive && ((0 != changed) || (status != pub->status))) {
+                getIvTopic(topic, iv, NULL, "available_text");
                 snprintf(val, 32, "%s%s%s%s",
                     (MQTT_STATUS_NOT_AVAIL_NOT_PROD) ? "not " : "",
                     "available and ",
                     (MQTT_STATUS_NOT_AVAIL_NOT_PROD || MQTT_STATUS_AVAIL_NOT_PROD) ? "not " : "",
                     "producing"
                 );
-                mMqtt.sendMsg(topic, val);
+                mMqtt.sendTopic(topic, val);
 
-                snprintf(topic, 32 + MAX_NAME_LENGTH, "%s/available", iv->name);
+                getIvTopic(topic, iv, NULL, "available");
                 snprintf(val, 32, "%d", status);
-                mMqtt.sendMsg(topic, val);
+                mMqtt.sendTopic(topic, val);
 
-                snprintf(topic, 32 + MAX_NAME_LENGTH, "%s/last_success", iv->name);
-                snprintf(val, 48, "%i", iv->getLastTs(rec) * 1000);
-                mMqtt.sendMsg(topic, val);
+                getIvTopic(topic, iv, NULL, "last_success");
+                snprintf(val, 32, "%u", iv->getLastTs(rec) * 1000);
+                mMqtt.sendTopic(topic, val);
             }
 
             // data
             for (uint8_t i = 0; i < rec->length; i++) {
-                snprintf(topic, 32 + MAX_NAME_LENGTH, "%s/ch%d/%s", iv->name, rec->assign[i].ch, fields[rec->assign[i].fieldId]);
-                snprintf(val, 10, "%.3f", iv->getValue(i, rec));
-                mMqtt.sendMsg(topic, val);
+                if (changed & (1ULL << i)) {
+                    if (getIvTopic(topic, iv, mqttChTopics[rec->assign[i].ch], fields[rec->assign[i].fieldId])) {
+                        iv->getValueStr(i, rec, val, 32);
+                        mMqtt.sendTopic(topic, val);
+                    }
+                }
+                yield();
+            }
+#endif
+            if (isLive)
+                pub->status = status;
 
-                // calculate total values for RealTimeRunData_Debug
-                if (mMqttSendList.front() == RealTimeRunData_Debug) {
+            // calculate total values for RealTimeRunData_Debug
+            if (isLive) {
+                for (uint8_t i = 0; i < rec->length; i++) {
                     if (CH0 == rec->assign[i].ch) {
                         switch (rec->assign[i].fieldId) {
                             case FLD_PAC:
                                 total[0] += iv->getValue(i, rec);
+                                totalDiv[0] = iv->getDiv(i, rec);
                                 break;
                             case FLD_YT:
                                 total[1] += iv->getValue(i, rec);
+                                totalDiv[1] = iv->getDiv(i, rec);
                                 break;
                             case FLD_YD:
                                 total[2] += iv->getValue(i, rec);
+                                totalDiv[2] = iv->getDiv(i, rec);
                                 break;
                             case FLD_PDC:
                                 total[3] += iv->getValue(i, rec);
+                                totalDiv[3] = iv->getDiv(i, rec);
                                 break;
                         }
                     }
-                    sendTotal = true;
                 }
-                yield();
+                sendTotal = true;
             }
         }
 
@@ -652,6 +951,9 @@ void app::sendMqtt(void) {
 
     if (true == sendTotal) {
         uint8_t fieldId;
+#if defined(MQTT_AGGREGATED)
+        uint16_t len = 0;
+#endif
         for (uint8_t i = 0; i < 4; i++) {
             switch (i) {
                 default:
@@ -668,11 +970,77 @@ void app::sendMqtt(void) {
                     fieldId = FLD_PDC;
                     break;
             }
-            snprintf(topic, 32 + MAX_NAME_LENGTH, "total/%s", fields[fieldId]);
-            snprintf(val, 10, "%.3f", total[i]);
-            mMqtt.sendMsg(topic, val);
+            fmtRecVal(val, 32, total[i], totalDiv[i]);
+#if defined(MQTT_AGGREGATED)
+            len += snprintf(&doc[len], MQTT_MAX_PACKET_SIZE - len, "%c\"%s\":%s", (0 == i) ? '{' : ',', fields[fieldId], val);
+#else
+            if (joinTopic(topic, "total/", 6, NULL, fields[fieldId]))
+                mMqtt.sendMsg(topic, val);
+#endif
+        }
+#if defined(MQTT_AGGREGATED)
+        snprintf(&doc[len], MQTT_MAX_PACKET_SIZE - len, "}");
+        mMqtt.sendMsg("total", doc);
+#endif
+    }
+}
+
+//-----------------------------------------------------------------------------
+uint64_t app::getMqttPubMask(Inverter<> *iv, record_t<> *rec, uint8_t cmd) {
+    mqttPubState_t *pub = &mMqttPub[iv->id];
+    uint8_t recIdx = 0; // unknown commands share the slot of the live record
+    for (uint8_t i = 0; i < 4; i++) {
+        if (mqttRecCmds[i] == cmd)
+            recIdx = i;
+    }
+
+    uint64_t mask = iv->getChanges(rec, REC_CONS_MQTT);
+    if ((0 == (pub->sent & (1 << recIdx))) || ((mUptimeSecs - pub->ts[recIdx]) >= MQTT_MAX_AGE)) {
+        // all values once after boot and then at least every MQTT_MAX_AGE
+        mask = (rec->length < 64) ? ((1ULL << rec->length) - 1) : ~0ULL;
+        pub->sent |= (1 << recIdx);
+        pub->ts[recIdx] = mUptimeSecs;
+    } else if (0 == recIdx) {
+        for (uint8_t i = 0; i < rec->length; i++) {
+            if (0 == (mask & (1ULL << i)))
+                continue;
+            uint8_t j = 0;
+            for (; j < DEADBAND_LIST_LEN; j++) {
+                if (fieldDeadband[j].fieldId == rec->assign[i].fieldId)
+                    break;
+            }
+            if (j >= DEADBAND_LIST_LEN)
+                continue;
+            float scale = iv->getScale(i, rec);
+            float last  = (float)pub->val[i] / scale;
+            float diff  = (float)(iv->getValueScaled(i, rec) - pub->val[i]) / scale;
+            float band  = fabs(last) * fieldDeadband[j].rel / 100.0f;
+            if (band < fieldDeadband[j].abs)
+                band = fieldDeadband[j].abs;
+            if (fabs(diff) < band)
+                mask &= ~(1ULL << i); // compared again with the next change
+        }
+    }
+
+    if (0 == recIdx) {
+        for (uint8_t i = 0; i < rec->length; i++) {
+            if (mask & (1ULL << i))
+                pub->val[i] = iv->getValueScaled(i, rec);
         }
     }
+    return mask;
+}
+
+//-----------------------------------------------------------------------------
+const char *app::getRecName(uint8_t cmd) {
+    switch (cmd) {
+        case RealTimeRunData_Debug: return "live";
+        case InverterDevInform_All: return "info";
+        case SystemConfigPara:      return "config";
+        case AlarmData:             return "alarm";
+        default:                    break;
+    }
+    return notAvail;
 }
 
 //-----------------------------------------------------------------------------
@@ -718,17 +1086,25 @@ void app::resetSystem(void) {
     mMqttInterval = MQTT_INTERVAL;
     mSerialTicker = 0xffff;
     mMqttActive = false;
+    mLinkPubTs = 0;
 
     mTicker = 0;
     mRxTicker = 0;
 
     mSendLastIvId = 0;
+    mPollRemaining = 0;
+    mIvCnt = 0;
+    mPayload = NULL;
+    mIvLink = NULL;
+    mMqttPub = NULL;
+#if (HISTORY_SIZE > 0)
+    mHistory = NULL;
+#endif
+    memset(mChLink, 0, sizeof(chLinkStat_t) * RF_CHANNELS);
 
     mShowRebootRequest = false;
 
-    memset(mPayload, 0, (MAX_NUM_INVERTERS * sizeof(invPayload_t)));
     memset(&mStat, 0, sizeof(statistics_t));
-    mLastPacketId = 0x00;
 }
 
 //-----------------------------------------------------------------------------
@@ -809,15 +1185,31 @@ void app::loadEEpconfig(void) {
                 mMqttInterval += mConfig.sendInterval;
             }
         }
+    }
 
-        for (uint8_t i = 0; i < MAX_NUM_INVERTERS; i++) {
-            iv = mSys->getInverterByPos(i, false);
-            if (NULL != iv)
-                resetPayload(iv);
-        }
+    allocIvState();
+    for (uint8_t i = 0; i < mIvCnt; i++) {
+        Inverter<> *iv = mSys->getInverterByPos(i, false);
+        if (NULL != iv)
+            resetPayload(iv);
     }
 }
 
+//-----------------------------------------------------------------------------
+void app::allocIvState(void) {
+    // the state per inverter is allocated for the configured inverters only
+    mIvCnt = mSys->getNumInverters();
+    mPayload = new invPayload_t[mIvCnt];
+    mIvLink = new ivLinkStat_t[mIvCnt];
+    memset(mPayload, 0, sizeof(invPayload_t) * mIvCnt);
+    memset(mIvLink, 0, sizeof(ivLinkStat_t) * mIvCnt);
+    mMqttPub = new mqttPubState_t[mIvCnt];
+    memset(mMqttPub, 0, sizeof(mqttPubState_t) * mIvCnt);
+#if (HISTORY_SIZE > 0)
+    mHistory = new HistoryType[mIvCnt][HISTORY_FLD_CNT];
+#endif
+}
+
 //-----------------------------------------------------------------------------
 void app::saveValues(void) {
     DPRINTLN(DBG_VERBOSE, F("app::saveValues"));
@@ -825,8 +1217,18 @@ void app::saveValues(void) {
     mEep->write(ADDR_CFG_SYS, (uint8_t *)&mSysConfig, CFG_SYS_LEN);
     mEep->write(ADDR_CFG, (uint8_t *)&mConfig, CFG_LEN);
     Inverter<> *iv;
+    char empty[MAX_NAME_LENGTH] = {0};
     for (uint8_t i = 0; i < MAX_NUM_INVERTERS; i++) {
         iv = mSys->getInverterByPos(i, false);
+        if (NULL == iv) { // unused slot
+            mEep->write(ADDR_INV_ADDR + (i * 8), (uint64_t)0);
+            mEep->write(ADDR_INV_NAME + (i * MAX_NAME_LENGTH), empty, MAX_NAME_LENGTH);
+            for (uint8_t j = 0; j < 4; j++) {
+                mEep->write(ADDR_INV_CH_PWR + (i * 2 * 4) + (j * 2), (uint16_t)0);
+                mEep->write(ADDR_INV_CH_NAME + (i * 4 * MAX_NAME_LENGTH) + j * MAX_NAME_LENGTH, empty, MAX_NAME_LENGTH);
+            }
+            continue;
+        }
         mEep->write(ADDR_INV_ADDR + (i * 8), iv->serial.u64);
         mEep->write(ADDR_INV_NAME + (i * MAX_NAME_LENGTH), iv->name, MAX_NAME_LENGTH);
         // max channel power / name
@@ -837,6 +1239,7 @@ void app::saveValues(void) {
     }
 
     updateCrc();
+    buildMqttTopics(); // names or topic may have changed
 
     // update sun
     mLatestSunTimestamp = 0;
@@ -853,16 +1256,29 @@ void app::setupMqtt(void) {
         }
 
         mMqttTicker = 0;
-        mMqtt.setup(&mConfig.mqtt, mSysConfig.deviceName);
+        mMqtt.setup(&mConfig.mqtt, mSysConfig.deviceName, mVersion); // version and device are sent once connected
+        buildMqttTopics();
+#if (MQTT_OUTBOX_SIZE > 0)
+        if (mMqttActive)
+            mOutbox.setup();
+#endif
         mMqtt.setCallback(std::bind(&app::cbMqtt, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+    }
+}
 
-        if (mMqttActive) {
-            mMqtt.sendMsg("version", mVersion);
-            if (mMqtt.isConnected()) {
-                mMqtt.sendMsg("device", mSysConfig.deviceName);
-                mMqtt.sendMsg("uptime", "0");
-            }
-        }
+//-----------------------------------------------------------------------------
+void app::buildMqttTopics(void) {
+    // the topics of the values are joined from these prefixes and the
+    // constant channel and field names, see getIvTopic()
+    mMqtt.setBaseTopic();
+    for (uint8_t id = 0; id < mIvCnt; id++) {
+        Inverter<> *iv = mSys->getInverterByPos(id, false);
+        if (NULL == iv)
+            continue;
+        mqttPubState_t *pub = &mMqttPub[iv->id];
+        pub->prefixLen = snprintf(pub->prefix, sizeof(pub->prefix), "%s/%s/", mConfig.mqtt.topic, iv->name);
+        if (pub->prefixLen >= sizeof(pub->prefix))
+            pub->prefixLen = sizeof(pub->prefix) - 1;
     }
 }
 
@@ -873,6 +1289,8 @@ void app::resetPayload(Inverter<> *iv) {
     mPayload[iv->id].txCmd = 0;
     mPayload[iv->id].retransmits = 0;
     mPayload[iv->id].maxPackId = 0;
+    mPayload[iv->id].rcvMask = 0;
+    mPayload[iv->id].polling = false;
     mPayload[iv->id].complete = false;
     mPayload[iv->id].requested = false;
     mPayload[iv->id].ts = mUtcTimestamp;
@@ -19,9 +19,10 @@
 #include "defines.h"
 #include "crc.h"
 
-#include "CircularBuffer.h"
 #include "hmSystem.h"
+#include "hmHistory.h"
 #include "mqtt.h"
+#include "mqttOutbox.h"
 #include "ahoywifi.h"
 #include "web.h"
 
@@ -33,19 +34,76 @@
 
 typedef HmSystem<MAX_NUM_INVERTERS> HmSystemType;
 
+static_assert(MAX_PAYLOAD_ENTRIES <= 16, "fragment bitmap (rcvMask) holds 16 fragments");
+
+#if (HISTORY_SIZE > 0)
+const uint8_t historyFields[] = HISTORY_FIELDS;
+#define HISTORY_FLD_CNT (sizeof(historyFields) / sizeof(uint8_t))
+typedef HmHistory<HISTORY_SIZE> HistoryType;
+#endif
+
+#if (MQTT_OUTBOX_SIZE > 0)
+const uint8_t outboxFields[] = MQTT_OUTBOX_FIELDS;
+#define OUTBOX_FLD_CNT (sizeof(outboxFields) / sizeof(uint8_t))
+typedef struct {
+    uint32_t ts;                 // timestamp of the payload
+    int32_t val[OUTBOX_FLD_CNT]; // CH0 values, see getValueScaled()
+    uint8_t id;                  // inverter
+} outboxEntry_t;
+typedef MqttOutbox<outboxEntry_t, MQTT_OUTBOX_SIZE> OutboxType;
+#endif
+
+typedef struct {
+    uint32_t frmCnt;      // valid fragments
+    uint32_t crcFail;
+    uint32_t dupCnt;
+    uint32_t missing;     // fragments still missing when the request was given up
+    uint32_t retransmits; // retransmit bursts
+    uint32_t reqMillis;   // time of the last request
+    uint16_t rtt;         // [ms] request to last fragment of the last payload
+    uint16_t rttAvg;      // [ms] moving average
+    uint32_t pubVal[6];   // last published values, see sendMqttLinkStat()
+} ivLinkStat_t;
+
+typedef struct {
+    uint32_t frmCnt;
+    uint32_t crcFail;
+    uint32_t dupCnt;
+    uint32_t pubVal[3];   // last published values, see sendMqttLinkStat()
+} chLinkStat_t;
+
 typedef struct {
     uint8_t txCmd;
     uint8_t txId;
     uint8_t invId;
     uint32_t ts;
-    uint8_t data[MAX_PAYLOAD_ENTRIES][MAX_RF_PAYLOAD_SIZE];
+    uint8_t data[MAX_PAYLOAD_ENTRIES * MAX_FRAGMENT_LEN]; // fragments are reassembled in place
     uint8_t len[MAX_PAYLOAD_ENTRIES];
+    uint16_t rcvMask; // bit n set: fragment n+1 received with valid crc
     bool complete;
     uint8_t maxPackId;
     uint8_t retransmits;
     bool requested;
+    bool polling; // request outstanding in the current poll round
+    uint8_t lastPacketId; // last frame id of the previous payload, kept on reset
 } invPayload_t;
 
+// channel part of the topic of a value, see getIvTopic()
+const char* const mqttChTopics[] = {"ch0/", "ch1/", "ch2/", "ch3/", "ch4/"};
+static_assert((sizeof(mqttChTopics) / sizeof(const char*)) == CH_CNT, "mqttChTopics doesn't match the channels");
+
+// records of mqttPubState_t::ts / sent
+const uint8_t mqttRecCmds[] = {RealTimeRunData_Debug, InverterDevInform_All, SystemConfigPara, AlarmData};
+
+typedef struct {
+    char prefix[MQTT_TOPIC_LEN + MAX_NAME_LENGTH + 2]; // <topic>/<name>/
+    uint8_t prefixLen;
+    int32_t val[REC_MAX_LEN]; // last published values of the live record, see getValueScaled()
+    uint32_t ts[4];           // [s] uptime of the last complete publish per record
+    uint8_t sent;             // bit per record, set after its first publish
+    uint8_t status;           // last published inverter state
+} mqttPubState_t;
+
 class ahoywifi;
 class web;
 
@@ -166,6 +224,20 @@ class app {
         inline bool getSettingsValid(void) { return mSettingsValid; }
         inline bool getRebootRequestState(void) { return mShowRebootRequest; }
         inline uint32_t getMqttTxCnt(void) { return mMqtt.getTxCnt(); }
+        inline ivLinkStat_t *getIvLinkStat(uint8_t id) { return &mIvLink[id]; }
+        inline chLinkStat_t *getChLinkStat(uint8_t chIdx) { return &mChLink[chIdx]; }
+        inline statistics_t *getStatistics(void) { return &mStat; }
+
+#if (HISTORY_SIZE > 0)
+        // history of a CH0 field of inverter id, NULL if it is not recorded
+        HistoryType *getHistory(uint8_t id, uint8_t fieldId) {
+            for(uint8_t i = 0; i < HISTORY_FLD_CNT; i++) {
+                if(historyFields[i] == fieldId)
+                    return &mHistory[id][i];
+            }
+            return NULL;
+        }
+#endif
 
         HmSystemType *mSys;
         bool mShouldReboot;
@@ -181,10 +253,29 @@ class app {
         void sendMqtt(void);
         
         bool buildPayload(uint8_t id);
+        uint8_t getPayloadLen(uint8_t id);
         void processPayload(bool retransmit);
+        void requestRetransmit(Inverter<> *iv);
+        void pollNextInverter(void);
+        void fillPollPipeline(void);
+        uint8_t getPollingCnt(void);
+        uint8_t getChIdx(uint8_t rxCh);
+        void sendMqttLinkStat(void);
+        void addHistory(Inverter<> *iv, record_t<> *rec);
+        void addOutbox(Inverter<> *iv, record_t<> *rec);
+        void sendOutbox(void);
+        void allocIvState(void);
 
         const char* getFieldDeviceClass(uint8_t fieldId);
         const char* getFieldStateClass(uint8_t fieldId);
+        const char* getRecName(uint8_t cmd);
+        uint64_t getMqttPubMask(Inverter<> *iv, record_t<> *rec, uint8_t cmd);
+        void buildMqttTopics(void);
+
+        // <topic>/<name>/<mid><suffix> of an inverter, mid may be NULL
+        inline bool getIvTopic(char buf[], Inverter<> *iv, const char *mid, const char *suffix) {
+            return joinTopic(buf, mMqttPub[iv->id].prefix, mMqttPub[iv->id].prefixLen, mid, suffix);
+        }
 
         inline uint16_t buildEEpCrc(uint32_t start, uint32_t length) {
             DPRINTLN(DBG_VERBOSE, F("main.h:buildEEpCrc"));
@@ -273,10 +364,16 @@ class app {
 
         uint16_t mSendTicker;
         uint8_t mSendLastIvId;
+        uint8_t mPollRemaining; // inverters left in the current poll round
 
-        invPayload_t mPayload[MAX_NUM_INVERTERS];
+        uint8_t mIvCnt; // inverters the state below is allocated for
+        invPayload_t *mPayload;
         statistics_t mStat;
-        uint8_t mLastPacketId;
+        ivLinkStat_t *mIvLink;
+        chLinkStat_t mChLink[RF_CHANNELS];
+#if (HISTORY_SIZE > 0)
+        HistoryType (*mHistory)[HISTORY_FLD_CNT];
+#endif
 
         // timer
         uint32_t mTicker;
@@ -287,7 +384,11 @@ class app {
         uint16_t mMqttTicker;
         uint16_t mMqttInterval;
         bool mMqttActive;
-        bool mMqttConfigSendState[MAX_NUM_INVERTERS];
+        mqttPubState_t *mMqttPub;
+        uint32_t mLinkPubTs;     // [s] uptime of the last publish of all link statistics
+#if (MQTT_OUTBOX_SIZE > 0)
+        OutboxType mOutbox;
+#endif
         std::queue<uint8_t> mMqttSendList;
 
         // serial
@@ -45,15 +45,37 @@
 #define DEF_CE_PIN              2
 #define DEF_IRQ_PIN             0
 
+// if the next line is uncommented, the NRF24 module is replaced by simulated
+// inverters (hmSimRadio.h), e.g. to measure throughput without hardware
+//#define SIM_RADIO
+
+// number of additional NRF24 modules which only receive (0 = single radio)
+// each of them is parked on another channel and polled, the IRQ pin is not
+// required. CE and CS pins are listed per module
+#define NUM_RX_RADIOS           0
+#define RX_RADIO_CE_PINS        {4, 16}
+#define RX_RADIO_CS_PINS        {5, 17}
+
 // default NRF24 power, possible values (0 - 3)
 #define DEF_AMPLIFIERPOWER      1
 
-// number of packets hold in buffer
-#define PACKET_BUFFER_SIZE      30
+// number of packets hold in buffer (power of two)
+#define PACKET_BUFFER_SIZE      32
 
-// number of configurable inverters
+// number of configurable inverters, RAM is only used for the configured ones
+// (the EEPROM layout depends on it: changing the value moves the inverter
+// settings and the settings CRC, all settings except WiFi are reset once)
 #define MAX_NUM_INVERTERS       4
 
+// RAM history of the CH0 fields below for /api/history, bytes per configured
+// inverter and field (0 = off), one sample takes about 2 - 4 bytes
+#if defined(ESP32)
+    #define HISTORY_SIZE        8192
+#else
+    #define HISTORY_SIZE        1024
+#endif
+#define HISTORY_FIELDS          {FLD_PAC, FLD_YD}
+
 // default serial interval
 #define SERIAL_INTERVAL         5
 
@@ -69,6 +91,10 @@
 // maximum total payload buffers (must be greater than the number of received frame fragments)
 #define MAX_PAYLOAD_ENTRIES     10
 
+// number of inverters which are requested back to back and answer
+// interleaved (pipelined polling), 1 = one inverter after another
+#define POLL_PIPELINE_DEPTH     2
+
 // maximum requests for retransmits per payload (per inverter)
 #define DEF_MAX_RETRANS_PER_PYLD 5
 
@@ -78,6 +104,10 @@
 // threshold of minimum power on which the inverter is marked as inactive
 #define INACT_PWR_THRESH        3
 
+// if the next line is uncommented, the inverter values are stored as the
+// received integers and scaled on output only (no soft float while decoding)
+//#define REC_FIXED_POINT
+
 // Timezone
 #define TIMEZONE                1
 
@@ -93,6 +123,22 @@
 // default mqtt interval
 #define MQTT_INTERVAL           60
 
+// [s] values which didn't change (or stay within the deadband, see
+// fieldDeadband in hmDefines.h) are published again after this time
+#define MQTT_MAX_AGE            300
+
+// [byte] flash (LittleFS) used to keep the fields below while the MQTT broker
+// can't be reached (0 = off), limited to a quarter of the file system. They
+// are sent to <topic>/<name>/backfill once it is back, MQTT_OUTBOX_RATE
+// entries per second
+#define MQTT_OUTBOX_SIZE        32768
+#define MQTT_OUTBOX_FIELDS      {FLD_PAC, FLD_YD, FLD_YT, FLD_PDC}
+#define MQTT_OUTBOX_RATE        4
+
+// publish all values of a record as one JSON document per inverter
+// (<topic>/<name>/live, .../info, ...) instead of one topic per field
+//#define MQTT_AGGREGATED
+
 // default MQTT broker uri
 #define DEF_MQTT_BROKER         "\0"
 
@@ -6,8 +6,8 @@
 #include "crc.h"
 
 namespace ah {
-    uint8_t crc8(uint8_t buf[], uint8_t len) {
-        uint8_t crc = CRC8_INIT;
+    uint8_t crc8(uint8_t buf[], uint8_t len, uint8_t start) {
+        uint8_t crc = start;
         for(uint8_t i = 0; i < len; i++) {
             crc ^= buf[i];
             for(uint8_t b = 0; b < 8; b ++) {
@@ -15,7 +15,7 @@
 #define CRC16_MODBUS_POLYNOM    0xA001
 
 namespace ah {
-    uint8_t crc8(uint8_t buf[], uint8_t len);
+    uint8_t crc8(uint8_t buf[], uint8_t len, uint8_t start = CRC8_INIT);
     uint16_t crc16(uint8_t buf[], uint8_t len, uint16_t start = 0xffff);
 }
 #endif /*__CRC_H__*/
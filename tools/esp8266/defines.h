@@ -96,9 +96,18 @@ typedef enum {
 #define MQTT_USER_LEN           16
 #define MQTT_PWD_LEN            32
 #define MQTT_TOPIC_LEN          32
+#define MQTT_TOPIC_MAX          (MQTT_TOPIC_LEN + MAX_NAME_LENGTH + 32) // <topic>/<name>/chX/<field>
 #define MQTT_DISCOVERY_PREFIX   "homeassistant"
-#define MQTT_MAX_PACKET_SIZE    384
-#define MQTT_RECONNECT_DELAY    5000
+#if defined(MQTT_AGGREGATED)
+    #define MQTT_MAX_PACKET_SIZE    1024
+#else
+    #define MQTT_MAX_PACKET_SIZE    384
+#endif
+#define MQTT_RECONNECT_DELAY    5000    // [ms] first wait after a failed connection
+#define MQTT_RECONNECT_DELAY_MAX 300000 // [ms] the wait doubles up to this value
+#define MQTT_CONNECT_TIMEOUT    500     // [ms] TCP connect
+#define MQTT_CONNACK_TIMEOUT    1       // [s] answer of the broker to CONNECT
+#define MQTT_DNS_TIMEOUT        5000    // [ms]
 
 #pragma pack(push)  // push current alignment to stack
 #pragma pack(1)     // set alignment to 1 byte boundary
@@ -158,6 +167,7 @@ typedef struct {
     uint32_t rxFailNoAnser;
     uint32_t rxSuccess;
     uint32_t frmCnt;
+    uint32_t spiBytes; // estimated SPI bytes of the last poll round (all inverters)
 } statistics_t;
 
 
@@ -79,9 +79,9 @@ class eep {
         }
 
         void read(uint32_t addr, uint64_t *value) {
-            read(addr, (uint32_t *)value);
-            *value <<= 32;
             uint32_t tmp;
+            read(addr, &tmp); // not through value, its type is uint64_t
+            *value = ((uint64_t)tmp << 32);
             read(addr+4, &tmp);
             *value |= tmp;
             /**value  = (EEPROM.read(addr++) << 56);
@@ -0,0 +1,203 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HM_CHANNEL_HOP_H__
+#define __HM_CHANNEL_HOP_H__
+
+#include <cstdint>
+#include <cstring>
+
+#define HOP_EXPLORE_CNT     8   // every n-th request of an inverter uses the next TX channel
+#define HOP_RX_SLOTS        12  // length of the RX dwell schedule (one slot per RX loop)
+#define HOP_DECAY_THRES     200 // all counters of an inverter are halved once one reaches this value
+
+typedef struct {
+    uint64_t invId;
+    uint8_t  txIdx;                 // TX channel of the last request
+    uint8_t  reqCnt;                // request counter for exploration
+    uint8_t  txReq[RF_CHANNELS];    // requests sent per TX channel
+    uint8_t  lost[RF_CHANNELS];     // fragments lost per TX channel
+    uint8_t  rx[RF_CHANNELS][RF_CHANNELS]; // fragments received per TX / RX channel
+} hopStat_t;
+
+/**
+ * Adaptive channel selection. For each inverter the fragments received per
+ * TX / RX channel pair and the fragments lost per TX channel are counted.
+ * A request is sent on the TX channel which delivered the most fragments per
+ * request, the RX dwell schedule spends most of its slots on the channels
+ * which answered to requests on this TX channel.
+ * Each RX channel keeps at least one slot and every HOP_EXPLORE_CNT-th
+ * request takes the next TX channel, that way the statistics recover if the
+ * radio conditions change.
+ * The statistics are allocated by setup() for the configured inverters.
+ */
+class HmChannelHop {
+    public:
+        HmChannelHop() {
+            hopStat_t s;
+            memset(&s, 0, sizeof(hopStat_t));
+            mStat  = NULL;
+            mSlots = 0;
+            mSlot  = 0;
+            mRxPos = 0;
+            buildRxSchedule(&s);
+        }
+        ~HmChannelHop() {}
+
+        void setup(uint8_t slots) {
+            if(NULL != mStat)
+                return;
+            mSlots = (0 == slots) ? 1 : slots;
+            mStat  = new hopStat_t[mSlots];
+            memset(mStat, 0, sizeof(hopStat_t) * mSlots);
+        }
+
+        // selects the TX channel index for a request to inverter invId and
+        // prepares the RX dwell schedule for its answer, the channel index
+        // avoid is not used (e.g. the one of the request sent just before)
+        uint8_t nextTx(uint64_t invId, uint8_t avoid = 0xff) {
+            mSlot = getSlot(invId);
+            hopStat_t *s = &mStat[mSlot];
+
+            if(0 == (++s->reqCnt % HOP_EXPLORE_CNT)) {
+                s->txIdx = (s->txIdx + 1) % RF_CHANNELS;
+                if(s->txIdx == avoid)
+                    s->txIdx = (s->txIdx + 1) % RF_CHANNELS;
+            }
+            else
+                s->txIdx = getBestTx(s, avoid);
+
+            if(++s->txReq[s->txIdx] >= HOP_DECAY_THRES)
+                decay(s);
+
+            buildRxSchedule(s);
+            mRxPos = 0;
+            return s->txIdx;
+        }
+
+        // RX channel index for the first dwell slot after a request
+        inline uint8_t firstRx(void) {
+            mRxPos = 0;
+            return mRxSched[0];
+        }
+
+        // RX channel index for the next dwell slot
+        uint8_t nextRx(void) {
+            if(++mRxPos >= HOP_RX_SLOTS)
+                mRxPos = 0;
+            return mRxSched[mRxPos];
+        }
+
+        void rxFragment(uint64_t invId, uint8_t rxIdx) {
+            if(rxIdx >= RF_CHANNELS)
+                return;
+            hopStat_t *s = &mStat[getSlot(invId)];
+            if(++s->rx[s->txIdx][rxIdx] >= HOP_DECAY_THRES)
+                decay(s);
+        }
+
+        void lostFragments(uint64_t invId, uint8_t cnt) {
+            hopStat_t *s = &mStat[getSlot(invId)];
+            if((uint16_t)s->lost[s->txIdx] + cnt >= HOP_DECAY_THRES)
+                decay(s);
+            s->lost[s->txIdx] += cnt;
+        }
+
+        hopStat_t *getStat(uint64_t invId) {
+            return &mStat[getSlot(invId)];
+        }
+
+    private:
+        uint8_t getSlot(uint64_t invId) {
+            if(NULL == mStat)
+                setup(1);
+            for(uint8_t i = 0; i < mSlots; i++) {
+                if(mStat[i].invId == invId)
+                    return i;
+                if(0ULL == mStat[i].invId) {
+                    mStat[i].invId = invId;
+                    return i;
+                }
+            }
+            return 0; // more inverters than slots, share the first one
+        }
+
+        uint8_t getBestTx(hopStat_t *s, uint8_t avoid) {
+            uint8_t best = (s->txIdx == avoid) ? ((avoid + 1) % RF_CHANNELS) : s->txIdx;
+            int16_t bestScore = -0x7fff;
+            for(uint8_t tx = 0; tx < RF_CHANNELS; tx++) {
+                if(tx == avoid)
+                    continue;
+                if(0 == s->txReq[tx])
+                    return tx; // not tried yet
+                int16_t delivered = 0;
+                for(uint8_t rx = 0; rx < RF_CHANNELS; rx++)
+                    delivered += s->rx[tx][rx];
+                int16_t score = ((delivered - s->lost[tx]) << 4) / s->txReq[tx];
+                if(score > bestScore) {
+                    bestScore = score;
+                    best = tx;
+                }
+            }
+            return best;
+        }
+
+        void decay(hopStat_t *s) {
+            for(uint8_t i = 0; i < RF_CHANNELS; i++) {
+                s->txReq[i] >>= 1;
+                s->lost[i]  >>= 1;
+                for(uint8_t j = 0; j < RF_CHANNELS; j++)
+                    s->rx[i][j] >>= 1;
+            }
+        }
+
+        void buildRxSchedule(hopStat_t *s) {
+            uint8_t cnt[RF_CHANNELS];
+            uint8_t *rx = s->rx[s->txIdx];
+            uint8_t free = HOP_RX_SLOTS - RF_CHANNELS;
+            uint16_t sum = 0;
+            uint8_t best = 0;
+
+            for(uint8_t i = 0; i < RF_CHANNELS; i++) {
+                sum += rx[i];
+                if(rx[i] > rx[best])
+                    best = i;
+            }
+
+            for(uint8_t i = 0; i < RF_CHANNELS; i++) {
+                cnt[i] = 1;
+                if(0 != sum) {
+                    uint8_t add = (rx[i] * (HOP_RX_SLOTS - RF_CHANNELS)) / sum;
+                    cnt[i] += add;
+                    free   -= add;
+                }
+            }
+            if(0 != sum)
+                cnt[best] += free;
+            else {
+                for(uint8_t i = 0; i < free; i++)
+                    cnt[i % RF_CHANNELS]++;
+            }
+
+            // interleave the slots to keep the gaps of each channel short
+            uint8_t pos = 0;
+            while(pos < HOP_RX_SLOTS) {
+                for(uint8_t i = 0; (i < RF_CHANNELS) && (pos < HOP_RX_SLOTS); i++) {
+                    if(0 != cnt[i]) {
+                        mRxSched[pos++] = i;
+                        cnt[i]--;
+                    }
+                }
+            }
+        }
+
+        hopStat_t *mStat;
+        uint8_t mSlots;
+        uint8_t mSlot;
+        uint8_t mRxSched[HOP_RX_SLOTS];
+        uint8_t mRxPos;
+};
+
+#endif /*__HM_CHANNEL_HOP_H__*/
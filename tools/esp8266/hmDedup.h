@@ -0,0 +1,96 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HM_DEDUP_H__
+#define __HM_DEDUP_H__
+
+#include <cstdint>
+#include <cstring>
+#include "crc.h"
+
+#define DEDUP_CACHE_SIZE    16
+#define DEDUP_TTL_MS        500 // copies of a frame within this time are dropped
+
+typedef struct {
+    uint16_t hash;
+    uint32_t ts;
+} dedupEntry_t;
+
+//-----------------------------------------------------------------------------
+// Duplicate frame filter
+//-----------------------------------------------------------------------------
+// Keeps a hash of (source address, packet id, crc8) of the recently received
+// frames. The hash is taken from the raw (shifted) frame, so no decoding is
+// required. Copies of the same frame, e.g. heard on two channels or by two
+// radios, are dropped before they use a slot of the packet buffer.
+// Only frames with a valid crc8 are cached, a corrupted copy would drop the
+// good copies of the same fragment otherwise.
+class HmDedup {
+    public:
+        HmDedup() {
+            memset(mCache, 0, sizeof(dedupEntry_t) * DEDUP_CACHE_SIZE);
+            mPos     = 0;
+            mDropCnt = 0;
+        }
+
+        // returns true if the raw frame was seen within DEDUP_TTL_MS,
+        // otherwise a valid frame is added to the cache
+        bool isDuplicate(uint8_t raw[]) {
+            uint8_t len = (raw[0] >> 2);
+            if(len > (MAX_RF_PAYLOAD_SIZE - 2))
+                len = MAX_RF_PAYLOAD_SIZE - 2;
+            if(!isCrcValid(raw, len))
+                return false; // passed on, counted as crc failure there
+
+            // shifted frame: source address raw[2..6], pid raw[10..11], crc8 raw[len..len+1]
+            uint16_t hash = 0x811c;
+            hash = addHash(hash, &raw[2], 5);
+            hash = addHash(hash, &raw[10], 2);
+            hash = addHash(hash, &raw[len], 2);
+            hash = addHash(hash, &len, 1);
+
+            uint32_t now = millis();
+            for(uint8_t i = 0; i < DEDUP_CACHE_SIZE; i++) {
+                if((mCache[i].hash == hash) && (0 != mCache[i].ts) && ((now - mCache[i].ts) < DEDUP_TTL_MS)) {
+                    mDropCnt++;
+                    return true;
+                }
+            }
+
+            mCache[mPos].hash = hash;
+            mCache[mPos].ts   = (0 == now) ? 1 : now;
+            mPos = (mPos + 1) % DEDUP_CACHE_SIZE;
+            return false;
+        }
+
+        inline uint32_t getDropCnt(void) {
+            return mDropCnt;
+        }
+
+    private:
+        // crc8 of the raw frame, decoded on the fly like checkPaketCrc()
+        bool isCrcValid(uint8_t raw[], uint8_t len) {
+            if(len < 2)
+                return false;
+            uint8_t crc = CRC8_INIT, b;
+            for(uint8_t i = 1; i < len; i++) {
+                b   = (raw[i] << 1) | (raw[i+1] >> 7);
+                crc = ah::crc8(&b, 1, crc);
+            }
+            return (crc == (uint8_t)((raw[len] << 1) | (raw[len+1] >> 7)));
+        }
+
+        inline uint16_t addHash(uint16_t hash, uint8_t buf[], uint8_t len) {
+            for(uint8_t i = 0; i < len; i++)
+                hash = (hash ^ buf[i]) * 0x0193;
+            return hash;
+        }
+
+        dedupEntry_t mCache[DEDUP_CACHE_SIZE];
+        uint8_t mPos;
+        uint32_t mDropCnt;
+};
+
+#endif /*__HM_DEDUP_H__*/
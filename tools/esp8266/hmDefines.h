@@ -61,6 +61,32 @@ const byteAssign_fieldDeviceClass deviceFieldAssignment[] = {
 };
 #define DEVICE_CLS_ASSIGN_LIST_LEN     (sizeof(deviceFieldAssignment) / sizeof(byteAssign_fieldDeviceClass))
 
+// mqtt deadband: a changed value is published if it moved by at least abs
+// (unit of the field) or rel (percent of the last published value), the
+// larger one applies. Fields which aren't listed are sent on every change
+typedef struct {
+    uint8_t fieldId;
+    float   abs;
+    uint8_t rel;
+} fieldDeadband_t;
+const fieldDeadband_t fieldDeadband[] = {
+    {FLD_UDC, 0.5,  0},
+    {FLD_IDC, 0.05, 2},
+    {FLD_PDC, 1,    2},
+    {FLD_YD,  10,   0},
+    {FLD_YT,  0.01, 0},
+    {FLD_UAC, 1,    0},
+    {FLD_IAC, 0.05, 2},
+    {FLD_PAC, 1,    2},
+    {FLD_F,   0.05, 0},
+    {FLD_T,   0.5,  0},
+    {FLD_PF,  0.01, 0},
+    {FLD_EFF, 0.5,  0},
+    {FLD_IRR, 1,    0},
+    {FLD_Q,   1,    2}
+};
+#define DEADBAND_LIST_LEN     (sizeof(fieldDeadband) / sizeof(fieldDeadband_t))
+
 // indices to calculation functions, defined in hmInverter.h
 enum {CALC_YT_CH0 = 0, CALC_YD_CH0, CALC_UDC_CH, CALC_PDC_CH0, CALC_EFF_CH0, CALC_IRR_CH};
 enum {CMD_CALC = 0xffff};
@@ -81,6 +107,40 @@ typedef struct {
     uint16_t   div;     // divisor / calc command
 } byteAssign_t;
 
+#define FLD_CNT     (FLD_LAST_ALARM_CODE + 1)
+#define CH_CNT      (CH4 + 1)
+#define POS_LUT_LEN (CH_CNT * FLD_CNT)
+
+/**
+ *  position of (ch, fieldId) inside an assignment table, 0xff if the table
+ *  does not contain it. Evaluated by the compiler if all arguments are
+ *  constant.
+ * */
+constexpr uint8_t assignPos(const byteAssign_t *assign, uint8_t len, uint8_t ch, uint8_t fieldId, uint8_t pos = 0) {
+    return (pos >= len) ? 0xff
+        : (((assign[pos].ch == ch) && (assign[pos].fieldId == fieldId)) ? pos
+        : assignPos(assign, len, ch, fieldId, pos + 1));
+}
+
+/**
+ *  lookup table [ch][fieldId] -> position for one assignment table, built at
+ *  compile time. It replaces the linear search of getPosByChFld
+ * */
+template<uint16_t... I> struct posSeq {};
+template<uint16_t N, uint16_t... I> struct posSeqGen : posSeqGen<N - 1, N - 1, I...> {};
+template<uint16_t... I> struct posSeqGen<0, I...> { typedef posSeq<I...> type; };
+
+template<const byteAssign_t *ASSIGN, uint8_t LEN, class SEQ = typename posSeqGen<POS_LUT_LEN>::type>
+struct posLut;
+
+template<const byteAssign_t *ASSIGN, uint8_t LEN, uint16_t... I>
+struct posLut<ASSIGN, LEN, posSeq<I...>> {
+    static constexpr uint8_t pos[POS_LUT_LEN] = { assignPos(ASSIGN, LEN, I / FLD_CNT, I % FLD_CNT)... };
+};
+
+template<const byteAssign_t *ASSIGN, uint8_t LEN, uint16_t... I>
+constexpr uint8_t posLut<ASSIGN, LEN, posSeq<I...>>::pos[POS_LUT_LEN];
+
 
 /**
  *  indices are built for the buffer starting with cmd-id in first byte
@@ -90,7 +150,7 @@ typedef struct {
 //-------------------------------------
 // HM-Series
 //-------------------------------------
-const byteAssign_t InfoAssignment[] = {
+constexpr byteAssign_t InfoAssignment[] = {
     { FLD_FW_VERSION,           UNIT_NONE,   CH0,  0, 2, 1 },
     { FLD_FW_BUILD_YEAR,        UNIT_NONE,   CH0,  2, 2, 1 },
     { FLD_FW_BUILD_MONTH_DAY,   UNIT_NONE,   CH0,  4, 2, 1 },
@@ -100,7 +160,7 @@ const byteAssign_t InfoAssignment[] = {
 #define HMINFO_LIST_LEN     (sizeof(InfoAssignment) / sizeof(byteAssign_t))
 #define HMINFO_PAYLOAD_LEN  14
 
-const byteAssign_t SystemConfigParaAssignment[] = {
+constexpr byteAssign_t SystemConfigParaAssignment[] = {
     { FLD_ACT_ACTIVE_PWR_LIMIT,    UNIT_PCT,   CH0,  2, 2, 10   }/*,
     { FLD_ACT_REACTIVE_PWR_LIMIT,  UNIT_PCT,   CH0,  4, 2, 10   },
     { FLD_ACT_PF,                  UNIT_NONE,  CH0,  6, 2, 1000 }*/
@@ -108,7 +168,7 @@ const byteAssign_t SystemConfigParaAssignment[] = {
 #define HMSYSTEM_LIST_LEN     (sizeof(SystemConfigParaAssignment) / sizeof(byteAssign_t))
 #define HMSYSTEM_PAYLOAD_LEN  14
 
-const byteAssign_t AlarmDataAssignment[] = {
+constexpr byteAssign_t AlarmDataAssignment[] = {
     { FLD_LAST_ALARM_CODE,           UNIT_NONE,   CH0,  0, 2, 1 }
 };
 #define HMALARMDATA_LIST_LEN     (sizeof(AlarmDataAssignment) / sizeof(byteAssign_t))
@@ -119,7 +179,7 @@ const byteAssign_t AlarmDataAssignment[] = {
 //-------------------------------------
 // HM300, HM350, HM400
 //-------------------------------------
-const byteAssign_t hm1chAssignment[] = {
+constexpr byteAssign_t hm1chAssignment[] = {
     { FLD_UDC, UNIT_V,    CH1,  2, 2, 10   },
     { FLD_IDC, UNIT_A,    CH1,  4, 2, 100  },
     { FLD_PDC, UNIT_W,    CH1,  6, 2, 10   },
@@ -147,7 +207,7 @@ const byteAssign_t hm1chAssignment[] = {
 //-------------------------------------
 // HM600, HM700, HM800
 //-------------------------------------
-const byteAssign_t hm2chAssignment[] = {
+constexpr byteAssign_t hm2chAssignment[] = {
     { FLD_UDC, UNIT_V,    CH1,  2, 2, 10   },
     { FLD_IDC, UNIT_A,    CH1,  4, 2, 100  },
     { FLD_PDC, UNIT_W,    CH1,  6, 2, 10   },
@@ -183,7 +243,7 @@ const byteAssign_t hm2chAssignment[] = {
 //-------------------------------------
 // HM1200, HM1500
 //-------------------------------------
-const byteAssign_t hm4chAssignment[] = {
+constexpr byteAssign_t hm4chAssignment[] = {
     { FLD_UDC, UNIT_V,    CH1,  2, 2, 10   },
     { FLD_IDC, UNIT_A,    CH1,  4, 2, 100  },
     { FLD_PDC, UNIT_W,    CH1,  8, 2, 10   },
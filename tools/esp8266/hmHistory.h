@@ -0,0 +1,145 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HM_HISTORY_H__
+#define __HM_HISTORY_H__
+
+#include <cstdint>
+#include <cstring>
+
+#define HISTORY_BLOCK_SIZE  64  // bytes per block
+#define HISTORY_BLOCK_HDR   5   // timestamp (4) + used bytes (1)
+
+/**
+ * Time series of one field in a fixed amount of RAM. The samples are stored
+ * in blocks, each block starts with the absolute timestamp and value of its
+ * first sample, all further samples are stored as difference to the previous
+ * one (seconds, value) as zigzag varints. Once all blocks are used the oldest
+ * one is dropped as a whole, so every block can be decoded on its own.
+ * Values are integers, e.g. the field scaled by the divisor of its assignment.
+ */
+template <uint16_t SIZE>
+class HmHistory {
+    public:
+        HmHistory() {
+            clear();
+        }
+        ~HmHistory() {}
+
+        void clear(void) {
+            mHead    = 0;
+            mCnt     = 0;
+            mLastTs  = 0;
+            mLastVal = 0;
+        }
+
+        void add(uint32_t ts, int32_t val) {
+            if((0 != mCnt) && (ts == mLastTs))
+                return; // same payload
+
+            uint8_t tmp[10];
+            uint8_t len = 0;
+            bool newBlk = (0 == mCnt) || (ts < mLastTs); // a time step back starts a new block
+            if(!newBlk) {
+                len  = putVarint(&tmp[0], ts - mLastTs);
+                len += putVarint(&tmp[len], zigzag(val - mLastVal));
+                newBlk = ((getUsed(mHead) + len) > HISTORY_BLOCK_SIZE);
+            }
+
+            if(newBlk) {
+                if(0 != mCnt)
+                    mHead = (mHead + 1) % BLOCKS;
+                if(mCnt < BLOCKS)
+                    mCnt++;
+                uint8_t *blk = mBlk[mHead];
+                memcpy(blk, &ts, 4);
+                len = putVarint(&blk[HISTORY_BLOCK_HDR], zigzag(val));
+                blk[4] = HISTORY_BLOCK_HDR + len;
+            }
+            else {
+                memcpy(&mBlk[mHead][getUsed(mHead)], tmp, len);
+                mBlk[mHead][4] += len;
+            }
+            mLastTs  = ts;
+            mLastVal = val;
+        }
+
+        // calls cb(ts, val) for all samples from the oldest to the newest one
+        template <class CB>
+        void forEach(CB cb) {
+            for(uint8_t i = 0; i < mCnt; i++) {
+                uint8_t *blk = mBlk[(mHead + BLOCKS - mCnt + 1 + i) % BLOCKS];
+                uint32_t ts;
+                uint32_t u;
+                memcpy(&ts, blk, 4);
+                uint8_t pos = HISTORY_BLOCK_HDR;
+                pos += getVarint(&blk[pos], &u);
+                int32_t val = unzigzag(u);
+                cb(ts, val);
+                while(pos < blk[4]) {
+                    pos += getVarint(&blk[pos], &u);
+                    ts += u;
+                    pos += getVarint(&blk[pos], &u);
+                    val += unzigzag(u);
+                    cb(ts, val);
+                }
+            }
+        }
+
+        uint32_t getFirstTs(void) {
+            if(0 == mCnt)
+                return 0;
+            uint32_t ts;
+            memcpy(&ts, mBlk[(mHead + BLOCKS - mCnt + 1) % BLOCKS], 4);
+            return ts;
+        }
+
+        inline uint32_t getLastTs(void) {
+            return mLastTs;
+        }
+
+    private:
+        static const uint8_t BLOCKS = SIZE / HISTORY_BLOCK_SIZE;
+        static_assert((SIZE / HISTORY_BLOCK_SIZE) >= 1 && (SIZE / HISTORY_BLOCK_SIZE) <= 255, "history size out of range");
+
+        inline uint8_t getUsed(uint8_t blk) {
+            return mBlk[blk][4];
+        }
+
+        inline uint32_t zigzag(int32_t v) {
+            return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+        }
+
+        inline int32_t unzigzag(uint32_t u) {
+            return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+        }
+
+        uint8_t putVarint(uint8_t buf[], uint32_t u) {
+            uint8_t len = 0;
+            while(u >= 0x80) {
+                buf[len++] = (u & 0x7f) | 0x80;
+                u >>= 7;
+            }
+            buf[len++] = u;
+            return len;
+        }
+
+        uint8_t getVarint(const uint8_t buf[], uint32_t *u) {
+            uint8_t len = 0;
+            *u = 0;
+            do {
+                *u |= (uint32_t)(buf[len] & 0x7f) << (7 * len);
+            } while(buf[len++] & 0x80);
+            return len;
+        }
+
+        uint8_t  mBlk[BLOCKS][HISTORY_BLOCK_SIZE];
+        uint8_t  mHead;     // block of the newest sample
+        uint8_t  mCnt;      // used blocks
+        uint32_t mLastTs;
+        int32_t  mLastVal;
+};
+
+#endif /*__HM_HISTORY_H__*/
@@ -12,8 +12,13 @@
 #endif
 
 #include "hmDefines.h"
-#include <memory>
-#include <queue>
+#include <type_traits>
+#include <atomic>
+
+#define CMD_QUEUE_SIZE      8   // pending commands per inverter
+#define MAX_CALC_CNT        16  // calculated fields per record
+#define REC_MAX_LEN         HM4CH_LIST_LEN  // values of the largest record
+#define SNAPSHOT_RETRIES    32  // copies tried while the record is written
 
 /**
  * For values which are of interest and not transmitted by the inverter can be
@@ -22,46 +27,70 @@
  * automatically. Their result does not differ from original read values.
  */
 
+#if defined(REC_FIXED_POINT)
+    typedef int32_t recVal_t; // raw value as received, scaled by byteAssign_t::div
+#else
+    typedef float   recVal_t;
+#endif
+
 // forward declaration of class
-template <class REC_TYP=float>
+template <class REC_TYP=recVal_t>
 class Inverter;
 
 
 // prototypes
-template<class T=float>
+template<class T=recVal_t>
 static T calcYieldTotalCh0(Inverter<> *iv, uint8_t arg0);
 
-template<class T=float>
+template<class T=recVal_t>
 static T calcYieldDayCh0(Inverter<> *iv, uint8_t arg0);
 
-template<class T=float>
+template<class T=recVal_t>
 static T calcUdcCh(Inverter<> *iv, uint8_t arg0);
 
-template<class T=float>
+template<class T=recVal_t>
 static T calcPowerDcCh0(Inverter<> *iv, uint8_t arg0);
 
-template<class T=float>
+template<class T=recVal_t>
 static T calcEffiencyCh0(Inverter<> *iv, uint8_t arg0);
 
-template<class T=float>
+template<class T=recVal_t>
 static T calcIrradiation(Inverter<> *iv, uint8_t arg0);
 
-template<class T=float>
+template<class T=recVal_t>
 using func_t = T (Inverter<> *, uint8_t);
 
-template<class T=float>
+template<class T=recVal_t>
 struct calcFunc_t {
     uint8_t funcId; // unique id
     func_t<T>*  func;   // function pointer
+    uint16_t div;       // divisor of the result if stored as integer
+    uint32_t deps;      // fields the result depends on (1 << FLD_..)
+    bool argCh;         // depends only on the fields of channel arg0
 };
 
-template<class T=float>
+// readers which get the changed positions of a record, see getChanges()
+enum {REC_CONS_MQTT = 0, REC_CONS_SERIAL, REC_CONS_HISTORY, REC_CONS_CNT};
+
+template<class T=recVal_t>
 struct record_t {
     byteAssign_t* assign; // assigment of bytes in payload
+    const uint8_t *lut;   // position lookup [ch][fieldId], see posLut
+    uint64_t (*decode)(T *record, const uint8_t buf[]); // see recDecoder, returns the changed positions
+    uint64_t dirty;       // positions changed by the current update
+    uint64_t changed[REC_CONS_CNT]; // positions changed since the last read of each consumer
     uint8_t length;       // length of the assignment list
     T *record;            // data pointer
     uint32_t ts;          // timestamp of last received payload
     uint8_t pyldLen;      // expected payload length for plausibility check
+    std::atomic<uint32_t> gen; // generation, odd while the record is written
+};
+
+// consistent copy of a record, see Inverter::getSnapshot()
+template<class T=recVal_t>
+struct recSnapshot_t {
+    record_t<T> rec;
+    T val[REC_MAX_LEN];
 };
 
 class CommandAbstract {
@@ -76,6 +105,10 @@ class CommandAbstract {
             return _Cmd;
         }
 
+        const uint8_t getTxType() {
+            return _TxType;
+        }
+
     protected:
         uint8_t _TxType;
         uint8_t _Cmd;
@@ -89,16 +122,104 @@ class InfoCommand : public CommandAbstract {
         }
 };
 
+// priority of queued commands, the highest is sent first
+enum {CMD_PRIO_REALTIME = 0, CMD_PRIO_INFO, CMD_PRIO_ALARM, CMD_PRIO_CTRL};
+
+typedef struct {
+    uint8_t txType;
+    uint8_t cmd;
+    uint8_t prio;
+} cmdEntry_t;
+
+/**
+ * Payload decoders generated from the assignment tables. Offset, length,
+ * divisor and sign of every field are template arguments, recDecoder<>
+ * expands to one straight-line function per table which loads all fields
+ * at their fixed offsets. Calculated fields are skipped.
+ */
+template<uint8_t START, uint8_t NUM>
+struct beLoad {
+    static inline uint32_t get(const uint8_t buf[]) {
+        return (beLoad<START, NUM - 1>::get(buf) << 8) | buf[START + NUM - 1];
+    }
+};
+
+template<uint8_t START>
+struct beLoad<START, 0> {
+    static inline uint32_t get(const uint8_t buf[]) { return 0; }
+};
+
+template<class T, uint8_t START, uint8_t NUM, uint16_t DIV, uint8_t FLD>
+struct fldDecoder {
+    static inline bool decode(T *val, const uint8_t buf[]) {
+        uint32_t raw = beLoad<START, NUM>::get(buf);
+        T v;
+        if(std::is_integral<T>::value)
+            v = (FLD_T == FLD) ? (T)((int16_t)raw) : (T)raw;
+        else if(FLD_T == FLD)
+            v = (T)((int16_t)raw) / (T)DIV; // temperature is a signed value!
+        else if(DIV > 1)
+            v = (T)raw / (T)DIV;
+        else
+            v = (T)raw;
+        if(v == *val)
+            return false;
+        *val = v;
+        return true;
+    }
+};
+
+template<class T, uint8_t START, uint8_t NUM, uint8_t FLD>
+struct fldDecoder<T, START, NUM, CMD_CALC, FLD> {
+    static inline bool decode(T *val, const uint8_t buf[]) { return false; }
+};
+
+template<class T, const byteAssign_t *ASSIGN, class SEQ>
+struct recDecoderImpl;
+
+template<class T, const byteAssign_t *ASSIGN, uint16_t... I>
+struct recDecoderImpl<T, ASSIGN, posSeq<I...>> {
+    static uint64_t decode(T *val, const uint8_t buf[]) {
+        uint64_t changed = 0;
+        int unused[] = { 0, (changed |= fldDecoder<T, ASSIGN[I].start, ASSIGN[I].num, ASSIGN[I].div, ASSIGN[I].fieldId>::decode(&val[I], buf) ? (1ULL << I) : 0ULL, 0)... };
+        (void)unused;
+        return changed;
+    }
+};
+
+static_assert(HM4CH_LIST_LEN <= 64, "record_t::dirty is too small");
+static_assert((HM1CH_LIST_LEN <= REC_MAX_LEN) && (HM2CH_LIST_LEN <= REC_MAX_LEN) && (HMINFO_LIST_LEN <= REC_MAX_LEN)
+    && (HMSYSTEM_LIST_LEN <= REC_MAX_LEN) && (HMALARMDATA_LIST_LEN <= REC_MAX_LEN), "recSnapshot_t is too small");
+
+template<class T, const byteAssign_t *ASSIGN, uint8_t LEN>
+struct recDecoder : recDecoderImpl<T, ASSIGN, typename posSeqGen<LEN>::type> {};
+
 // list of all available functions, mapped in hmDefines.h
-template<class T=float>
+template<class T=recVal_t>
 const calcFunc_t<T> calcFunctions[] = {
-    { CALC_YT_CH0,  &calcYieldTotalCh0 },
-    { CALC_YD_CH0,  &calcYieldDayCh0   },
-    { CALC_UDC_CH,  &calcUdcCh         },
-    { CALC_PDC_CH0, &calcPowerDcCh0    },
-    { CALC_EFF_CH0, &calcEffiencyCh0   },
-    { CALC_IRR_CH,  &calcIrradiation   }
+    { CALC_YT_CH0,  &calcYieldTotalCh0, 1000, (1UL << FLD_YT),                     false },
+    { CALC_YD_CH0,  &calcYieldDayCh0,   1,    (1UL << FLD_YD),                     false },
+    { CALC_UDC_CH,  &calcUdcCh,         10,   (1UL << FLD_UDC),                    true  },
+    { CALC_PDC_CH0, &calcPowerDcCh0,    10,   (1UL << FLD_PDC),                    false },
+    { CALC_EFF_CH0, &calcEffiencyCh0,   100,  (1UL << FLD_PAC) | (1UL << FLD_PDC), false },
+    { CALC_IRR_CH,  &calcIrradiation,   100,  (1UL << FLD_PDC),                    true  }
 };
+static_assert(FLD_CNT <= 32, "calcFunc_t::deps is too small");
+
+// formats a record value, integers are printed as decimal fraction of div
+static inline void fmtRecVal(char *buf, uint8_t len, float val, uint16_t div) {
+    snprintf(buf, len, "%.3f", val);
+}
+
+static inline void fmtRecVal(char *buf, uint8_t len, int32_t val, uint16_t div) {
+    if(div <= 1) {
+        snprintf(buf, len, "%ld", (long)val);
+        return;
+    }
+    uint8_t dec = (div >= 1000) ? 3 : ((div >= 100) ? 2 : 1);
+    uint32_t mag = (val < 0) ? -val : val;
+    snprintf(buf, len, "%s%lu.%0*lu", (val < 0) ? "-" : "", (unsigned long)(mag / div), dec, (unsigned long)(mag % div));
+}
 
 
 template <class REC_TYP>
@@ -135,6 +256,10 @@ class Inverter {
             fwVersion = 0;
             lastAlarmMsg =  "nothing";
             alarmMesIndex = 0;
+            mCmdHead = 0;
+            mCmdCnt = 0;
+            mCmdActive = false;
+            mCalcCnt = 0;
         }
 
         ~Inverter() {
@@ -143,26 +268,25 @@ class Inverter {
 
         template <typename T>
         void enqueCommand(uint8_t cmd) {
-           _commandQueue.push(std::make_shared<T>(cmd));
-           DPRINTLN(DBG_INFO, "enqueuedCmd: " + String(cmd));
+            T c(cmd);
+            pushCmd(c.getTxType(), c.getCmd());
         }
 
         void setQueuedCmdFinished() {
-            if (!_commandQueue.empty()) {
-                // Will destroy CommandAbstract Class Object (?)
-                _commandQueue.pop(); 
+            if (0 != mCmdCnt) {
+                mCmdHead = (mCmdHead + 1) % CMD_QUEUE_SIZE;
+                mCmdCnt--;
             }
+            mCmdActive = false;
         }
 
         void clearCmdQueue() {
-            while (!_commandQueue.empty()) {
-                // Will destroy CommandAbstract Class Object (?)
-                _commandQueue.pop(); 
-            }
+            mCmdCnt    = 0;
+            mCmdActive = false;
         }
 
     	uint8_t getQueuedCmd() {
-            if (_commandQueue.empty()){
+            if (0 == mCmdCnt){
                 // Fill with default commands
                 enqueCommand<InfoCommand>(RealTimeRunData_Debug);
                 if (fwVersion == 0)
@@ -174,7 +298,8 @@ class Inverter {
                     enqueCommand<InfoCommand>(SystemConfigPara);
                 }
             }
-            return _commandQueue.front().get()->getCmd();
+            mCmdActive = true; // sent, keep it in front until finished
+            return mCmdQueue[mCmdHead].cmd;
         }
 
 
@@ -184,24 +309,17 @@ class Inverter {
             initAssignment(&recordInfo, InverterDevInform_All);
             initAssignment(&recordConfig, SystemConfigPara);
             initAssignment(&recordAlarm, AlarmData);
+            initCalc(&recordMeas);
             toRadioId();
             memset(name, 0, MAX_NAME_LENGTH);
             memset(chName, 0, MAX_NAME_LENGTH * 4);
             initialized = true;
         }
 
-        uint8_t getPosByChFld(uint8_t channel, uint8_t fieldId, record_t<> *rec) {
-            DPRINTLN(DBG_VERBOSE, F("hmInverter.h:getPosByChFld"));
-            uint8_t pos = 0;
-            if(NULL != rec) {
-                for(; pos < rec->length; pos++) {
-                    if((rec->assign[pos].ch == channel) && (rec->assign[pos].fieldId == fieldId))
-                        break;
-                }
-                return (pos >= rec->length) ? 0xff : pos;
-            }
-            else
+        inline uint8_t getPosByChFld(uint8_t channel, uint8_t fieldId, record_t<> *rec) {
+            if((NULL == rec) || (NULL == rec->lut) || (channel >= CH_CNT) || (fieldId >= FLD_CNT))
                 return 0xff;
+            return rec->lut[channel * FLD_CNT + fieldId];
         }
 
         byteAssign_t *getByteAssign(uint8_t pos, record_t<> *rec) {
@@ -243,7 +361,15 @@ class Inverter {
                             val <<= 8;
                             val |= buf[ptr];
                         } while(++ptr != end);
-                        if(FLD_T == rec->assign[pos].fieldId) {
+                        REC_TYP old = rec->record[pos];
+                        if(std::is_integral<REC_TYP>::value) {
+                            // fixed point: keep the raw value, div is applied on output
+                            if(FLD_T == rec->assign[pos].fieldId)
+                                rec->record[pos] = (REC_TYP)((int16_t)val);
+                            else
+                                rec->record[pos] = (REC_TYP)(val);
+                        }
+                        else if(FLD_T == rec->assign[pos].fieldId) {
                             // temperature is a signed value!
                             rec->record[pos] = (REC_TYP)((int16_t)val) / (REC_TYP)(div);
                         }
@@ -253,51 +379,158 @@ class Inverter {
                             else
                                 rec->record[pos] = (REC_TYP)(val);
                         }
+                        if(old != rec->record[pos])
+                            rec->dirty |= (1ULL << pos);
                     }
                 }
 
-                if(rec == &recordMeas) {
-                    DPRINTLN(DBG_VERBOSE, "add real time");
+                updateState(pos, rec);
+            }
+            else
+                DPRINTLN(DBG_ERROR, F("addValue: assignment not found with cmd 0x"));
+        }
+
+        // decodes a complete payload with the generated decoder of the record
+        void addValues(uint8_t buf[], record_t<> *rec) {
+            DPRINTLN(DBG_VERBOSE, F("hmInverter.h:addValues"));
+            if(NULL == rec)
+                return;
+            if(NULL == rec->decode) {
+                for(uint8_t i = 0; i < rec->length; i++)
+                    addValue(i, buf, rec);
+                return;
+            }
 
-                    // get last alarm message index and save it in the inverter object
-                    if (getPosByChFld(0, FLD_EVT, rec) == pos){
-                        if (alarmMesIndex < rec->record[pos]){
-                            alarmMesIndex = rec->record[pos];
-                            //enqueCommand<InfoCommand>(AlarmUpdate); // What is the function of AlarmUpdate?
-                            enqueCommand<InfoCommand>(AlarmData);
-                        }
-                        else {
-                            alarmMesIndex = rec->record[pos]; // no change
-                        }
+            rec->dirty |= rec->decode(rec->record, buf);
+
+            uint8_t pos = 0xff;
+            if(rec == &recordMeas)
+                pos = getPosByChFld(CH0, FLD_EVT, rec);
+            else if(rec == &recordInfo)
+                pos = getPosByChFld(CH0, FLD_FW_VERSION, rec);
+            else if(rec == &recordConfig)
+                pos = getPosByChFld(CH0, FLD_ACT_ACTIVE_PWR_LIMIT, rec);
+            else if(rec == &recordAlarm)
+                pos = getPosByChFld(CH0, FLD_LAST_ALARM_CODE, rec);
+            if(0xff != pos)
+                updateState(pos, rec);
+        }
+
+        // takes over values which change the state of the inverter object
+        void updateState(uint8_t pos, record_t<> *rec) {
+            if(rec == &recordMeas) {
+                DPRINTLN(DBG_VERBOSE, "add real time");
+
+                // get last alarm message index and save it in the inverter object
+                if (getPosByChFld(0, FLD_EVT, rec) == pos){
+                    if (alarmMesIndex < rec->record[pos]){
+                        alarmMesIndex = rec->record[pos];
+                        //enqueCommand<InfoCommand>(AlarmUpdate); // What is the function of AlarmUpdate?
+                        enqueCommand<InfoCommand>(AlarmData);
                     }
-                }
-                else if (rec->assign == InfoAssignment) {
-                    DPRINTLN(DBG_DEBUG, "add info");
-                    // get at least the firmware version and save it to the inverter object
-                    if (getPosByChFld(0, FLD_FW_VERSION, rec) == pos){
-                        fwVersion = rec->record[pos];
-                        DPRINT(DBG_DEBUG, F("Inverter FW-Version: ") + String(fwVersion));
+                    else {
+                        alarmMesIndex = rec->record[pos]; // no change
                     }
                 }
-                else if (rec->assign == SystemConfigParaAssignment) {
-                    DPRINTLN(DBG_DEBUG, "add config");
-                    // get at least the firmware version and save it to the inverter object
-                    if (getPosByChFld(0, FLD_ACT_ACTIVE_PWR_LIMIT, rec) == pos){
-                        actPowerLimit = rec->record[pos];
-                        DPRINT(DBG_DEBUG, F("Inverter actual power limit: ") + String(actPowerLimit, 1));
-                    }
+            }
+            else if (rec->assign == InfoAssignment) {
+                DPRINTLN(DBG_DEBUG, "add info");
+                // get at least the firmware version and save it to the inverter object
+                if (assignPos(InfoAssignment, HMINFO_LIST_LEN, CH0, FLD_FW_VERSION) == pos){
+                    fwVersion = rec->record[pos];
+                    DPRINT(DBG_DEBUG, F("Inverter FW-Version: ") + String(fwVersion));
                 }
-                else if (rec->assign == AlarmDataAssignment) {
-                    DPRINTLN(DBG_DEBUG, "add alarm");
-                    if (getPosByChFld(0, FLD_LAST_ALARM_CODE, rec) == pos){
-                        lastAlarmMsg = getAlarmStr(rec->record[pos]);
-                    }
+            }
+            else if (rec->assign == SystemConfigParaAssignment) {
+                DPRINTLN(DBG_DEBUG, "add config");
+                // get at least the firmware version and save it to the inverter object
+                if (assignPos(SystemConfigParaAssignment, HMSYSTEM_LIST_LEN, CH0, FLD_ACT_ACTIVE_PWR_LIMIT) == pos){
+                    actPowerLimit = (float)rec->record[pos] / (float)getDiv(pos, rec);
+                    DPRINT(DBG_DEBUG, F("Inverter actual power limit: ") + String(actPowerLimit, 1));
+                }
+            }
+            else if (rec->assign == AlarmDataAssignment) {
+                DPRINTLN(DBG_DEBUG, "add alarm");
+                if (assignPos(AlarmDataAssignment, HMALARMDATA_LIST_LEN, CH0, FLD_LAST_ALARM_CODE) == pos){
+                    lastAlarmMsg = getAlarmStr(rec->record[pos]);
                 }
-                else
-                    DPRINTLN(DBG_WARN, F("add with unknown assginment"));
             }
             else
-                DPRINTLN(DBG_ERROR, F("addValue: assignment not found with cmd 0x"));
+                DPRINTLN(DBG_WARN, F("add with unknown assginment"));
+        }
+
+        // a payload is written between beginUpdate() and endUpdate(), the
+        // generation tells readers in another context (web server on ESP32)
+        // whether their copy is complete
+        void beginUpdate(record_t<> *rec) {
+            rec->gen.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+
+        void endUpdate(record_t<> *rec) {
+            for(uint8_t i = 0; i < REC_CONS_CNT; i++)
+                rec->changed[i] |= rec->dirty;
+            rec->dirty = 0;
+            rec->gen.fetch_add(1, std::memory_order_release);
+        }
+
+        // positions changed since the last call of the consumer (REC_CONS_..)
+        uint64_t getChanges(record_t<> *rec, uint8_t consumer) {
+            uint64_t chg = rec->changed[consumer];
+            rec->changed[consumer] = 0;
+            return chg;
+        }
+
+        uint32_t getGeneration(record_t<> *rec) {
+            return rec->gen.load(std::memory_order_acquire);
+        }
+
+        // copies a complete generation of rec to snap. Returns false if the
+        // generation is still *lastGen (nothing new to read, snap untouched)
+        // or the writer did not finish in time, snap holds an empty record
+        // (no values, ts 0) then. *lastGen is set to the copied generation.
+        bool getSnapshot(record_t<> *rec, recSnapshot_t<> *snap, uint32_t *lastGen = NULL) {
+            if(NULL == rec)
+                return false;
+            for(uint8_t i = 0; i < SNAPSHOT_RETRIES; i++) {
+                if(0 != i)
+                    waitWriter();
+                uint32_t gen = rec->gen.load(std::memory_order_acquire);
+                if(gen & 1)
+                    continue; // update in progress
+                if((NULL != lastGen) && (*lastGen == gen))
+                    return false;
+
+                snap->rec.ts = rec->ts;
+                memcpy(snap->val, rec->record, rec->length * sizeof(REC_TYP));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(rec->gen.load(std::memory_order_relaxed) != gen)
+                    continue; // overwritten while copying
+
+                snap->rec.assign  = rec->assign;
+                snap->rec.lut     = rec->lut;
+                snap->rec.decode  = NULL;
+                snap->rec.dirty   = 0;
+                memset(snap->rec.changed, 0, sizeof(uint64_t) * REC_CONS_CNT);
+                snap->rec.length  = rec->length;
+                snap->rec.record  = snap->val;
+                snap->rec.pyldLen = rec->pyldLen;
+                snap->rec.gen.store(gen, std::memory_order_relaxed);
+                if(NULL != lastGen)
+                    *lastGen = gen;
+                return true;
+            }
+
+            snap->rec.ts      = 0;
+            snap->rec.assign  = rec->assign;
+            snap->rec.lut     = rec->lut;
+            snap->rec.decode  = NULL;
+            snap->rec.dirty   = 0;
+            memset(snap->rec.changed, 0, sizeof(uint64_t) * REC_CONS_CNT);
+            snap->rec.length  = 0;
+            snap->rec.record  = snap->val;
+            snap->rec.pyldLen = rec->pyldLen;
+            return false;
         }
 
         REC_TYP getValue(uint8_t pos, record_t<> *rec) {
@@ -307,17 +540,56 @@ class Inverter {
             return rec->record[pos];
         }
 
+        // divisor of a stored value, 1 if values are stored as float
+        uint16_t getDiv(uint8_t pos, record_t<> *rec) {
+            if(!std::is_integral<REC_TYP>::value)
+                return 1;
+            return getScale(pos, rec);
+        }
+
+        // divisor of a value as transmitted (or calculated as integer)
+        uint16_t getScale(uint8_t pos, record_t<> *rec) {
+            if(NULL == rec)
+                return 1;
+            if(CMD_CALC == rec->assign[pos].div)
+                return calcFunctions<REC_TYP>[rec->assign[pos].start].div;
+            return rec->assign[pos].div;
+        }
+
+        // value as integer scaled by getScale()
+        int32_t getValueScaled(uint8_t pos, record_t<> *rec) {
+            if(std::is_integral<REC_TYP>::value)
+                return (int32_t)getValue(pos, rec);
+            float val = (float)getValue(pos, rec) * getScale(pos, rec);
+            return (int32_t)((val < 0) ? (val - 0.5f) : (val + 0.5f));
+        }
+
+        void getValueStr(uint8_t pos, record_t<> *rec, char *buf, uint8_t len) {
+            fmtRecVal(buf, len, getValue(pos, rec), getDiv(pos, rec));
+        }
+
+        // recalculates the fields whose inputs changed in the current update,
+        // a changed result marks its position for the fields depending on it
         void doCalculations() {
             DPRINTLN(DBG_VERBOSE, F("hmInverter.h:doCalculations"));
             record_t<> *rec = getRecordStruct(RealTimeRunData_Debug);
-            for(uint8_t i = 0; i < rec->length; i++) {
-                if(CMD_CALC == rec->assign[i].div) {
-                    rec->record[i] = calcFunctions<REC_TYP>[rec->assign[i].start].func(this, rec->assign[i].num);
+            for(uint8_t i = 0; i < mCalcCnt; i++) {
+                if(0 == (rec->dirty & mCalcDeps[i]))
+                    continue;
+                uint8_t pos = mCalcPos[i];
+                REC_TYP val = calcFunctions<REC_TYP>[rec->assign[pos].start].func(this, rec->assign[pos].num);
+                if(val != rec->record[pos]) {
+                    rec->record[pos] = val;
+                    rec->dirty |= (1ULL << pos);
                 }
-                yield();
             }
         }
 
+        // forces a calculation of all fields, e.g. after chMaxPwr changed
+        void invalidateCalc(void) {
+            recordMeas.dirty = ~0ULL;
+        }
+
         bool isAvailable(uint32_t timestamp, record_t<> *rec) {
             DPRINTLN(DBG_VERBOSE, F("hmInverter.h:isAvailable"));
             return ((timestamp - rec->ts) < INACT_THRES_SEC);
@@ -327,7 +599,7 @@ class Inverter {
             DPRINTLN(DBG_VERBOSE, F("hmInverter.h:isProducing"));
             if(isAvailable(timestamp, rec)) {
                 uint8_t pos = getPosByChFld(CH0, FLD_PAC, rec);
-                return (getValue(pos, rec) > INACT_PWR_THRESH);
+                return (getValue(pos, rec) > (REC_TYP)(INACT_PWR_THRESH * getDiv(pos, rec)));
             }
             return false;
         }
@@ -352,29 +624,42 @@ class Inverter {
             DPRINTLN(DBG_VERBOSE, F("hmInverter.h:initAssignment"));
             rec->ts     = 0;
             rec->length = 0;
+            rec->lut    = NULL;
+            rec->decode = NULL;
+            rec->dirty  = ~0ULL;
+            memset(rec->changed, 0, sizeof(uint64_t) * REC_CONS_CNT);
+            rec->gen.store(0, std::memory_order_relaxed);
             switch (cmd) {
                 case RealTimeRunData_Debug:
                     if (INV_TYPE_1CH == type) {
                         rec->length  = (uint8_t)(HM1CH_LIST_LEN);
                         rec->assign  = (byteAssign_t *)hm1chAssignment;
+                        rec->lut     = posLut<hm1chAssignment, HM1CH_LIST_LEN>::pos;
+                        rec->decode  = recDecoder<REC_TYP, hm1chAssignment, HM1CH_LIST_LEN>::decode;
                         rec->pyldLen = HM1CH_PAYLOAD_LEN;
                         channels     = 1;
                     }
                     else if (INV_TYPE_2CH == type) {
                         rec->length  = (uint8_t)(HM2CH_LIST_LEN);
                         rec->assign  = (byteAssign_t *)hm2chAssignment;
+                        rec->lut     = posLut<hm2chAssignment, HM2CH_LIST_LEN>::pos;
+                        rec->decode  = recDecoder<REC_TYP, hm2chAssignment, HM2CH_LIST_LEN>::decode;
                         rec->pyldLen = HM2CH_PAYLOAD_LEN;
                         channels     = 2;
                     }
                     else if (INV_TYPE_4CH == type) {
                         rec->length  = (uint8_t)(HM4CH_LIST_LEN);
                         rec->assign  = (byteAssign_t *)hm4chAssignment;
+                        rec->lut     = posLut<hm4chAssignment, HM4CH_LIST_LEN>::pos;
+                        rec->decode  = recDecoder<REC_TYP, hm4chAssignment, HM4CH_LIST_LEN>::decode;
                         rec->pyldLen = HM4CH_PAYLOAD_LEN;
                         channels     = 4;
                     }
                     else {
                         rec->length  = 0;
                         rec->assign  = NULL;
+                        rec->lut     = NULL;
+                        rec->decode  = NULL;
                         rec->pyldLen = 0;
                         channels     = 0;
                     }
@@ -382,16 +667,22 @@ class Inverter {
                 case InverterDevInform_All:
                     rec->length  = (uint8_t)(HMINFO_LIST_LEN);
                     rec->assign  = (byteAssign_t *)InfoAssignment;
+                    rec->lut     = posLut<InfoAssignment, HMINFO_LIST_LEN>::pos;
+                    rec->decode  = recDecoder<REC_TYP, InfoAssignment, HMINFO_LIST_LEN>::decode;
                     rec->pyldLen = HMINFO_PAYLOAD_LEN;
                     break;
                 case SystemConfigPara:
                     rec->length  = (uint8_t)(HMSYSTEM_LIST_LEN);
                     rec->assign  = (byteAssign_t *)SystemConfigParaAssignment;
+                    rec->lut     = posLut<SystemConfigParaAssignment, HMSYSTEM_LIST_LEN>::pos;
+                    rec->decode  = recDecoder<REC_TYP, SystemConfigParaAssignment, HMSYSTEM_LIST_LEN>::decode;
                     rec->pyldLen = HMSYSTEM_PAYLOAD_LEN;
                     break;
                 case AlarmData:
                     rec->length  = (uint8_t)(HMALARMDATA_LIST_LEN);
                     rec->assign  = (byteAssign_t *)AlarmDataAssignment;
+                    rec->lut     = posLut<AlarmDataAssignment, HMALARMDATA_LIST_LEN>::pos;
+                    rec->decode  = recDecoder<REC_TYP, AlarmDataAssignment, HMALARMDATA_LIST_LEN>::decode;
                     rec->pyldLen = HMALARMDATA_PAYLOAD_LEN;
                     break;
                 default:
@@ -405,6 +696,50 @@ class Inverter {
             }
         }
 
+        // collects the calculated fields of a record with the positions they
+        // depend on, a field which depends on other calculated fields is
+        // placed behind them
+        void initCalc(record_t<> *rec) {
+            DPRINTLN(DBG_VERBOSE, F("hmInverter.h:initCalc"));
+            uint64_t calcMask = 0;
+            uint64_t deps[MAX_CALC_CNT];
+            uint8_t  pos[MAX_CALC_CNT];
+            uint8_t  cnt = 0;
+
+            mCalcCnt = 0;
+            for(uint8_t i = 0; (i < rec->length) && (cnt < MAX_CALC_CNT); i++) {
+                if(CMD_CALC != rec->assign[i].div)
+                    continue;
+                const calcFunc_t<REC_TYP> *f = &calcFunctions<REC_TYP>[rec->assign[i].start];
+                deps[cnt] = 0;
+                for(uint8_t j = 0; j < rec->length; j++) {
+                    if((j == i) || (0 == (f->deps & (1UL << rec->assign[j].fieldId))))
+                        continue;
+                    if(f->argCh && (rec->assign[j].ch != rec->assign[i].num))
+                        continue;
+                    deps[cnt] |= (1ULL << j);
+                }
+                pos[cnt++] = i;
+                calcMask |= (1ULL << i);
+            }
+
+            // topological order, a cycle is appended in table order
+            uint64_t done = 0;
+            while(mCalcCnt < cnt) {
+                uint8_t added = 0;
+                for(uint8_t i = 0; i < cnt; i++) {
+                    if((done & (1ULL << pos[i])) || (deps[i] & calcMask & ~done))
+                        continue;
+                    mCalcPos[mCalcCnt]    = pos[i];
+                    mCalcDeps[mCalcCnt++] = deps[i];
+                    done |= (1ULL << pos[i]);
+                    added++;
+                }
+                if(0 == added)
+                    calcMask = done;
+            }
+        }
+
         String getAlarmStr(u_int16_t alarmCode) {
             switch (alarmCode) { // breaks are intentionally missing!
                 case 1:    return String(F("Inverter start"));
@@ -480,7 +815,73 @@ class Inverter {
         }
 
     private:
-        std::queue<std::shared_ptr<CommandAbstract>> _commandQueue;
+        // lets the writer of a record go on (loop task on ESP32). On ESP8266
+        // the web server runs in the system context between two loops, the
+        // writer can't continue before the reader returned
+        inline void waitWriter(void) {
+            #if defined(ESP32)
+            yield();
+            #endif
+        }
+
+        // commands are kept sorted by priority, same priority in order of
+        // arrival, a command which is already pending is not added again
+        void pushCmd(uint8_t txType, uint8_t cmd) {
+            uint8_t prio = getCmdPrio(txType, cmd);
+            // the active entry is not compared, it may be removed without
+            // being answered (e.g. a failed poll)
+            uint8_t first = (mCmdActive) ? 1 : 0;
+            for(uint8_t i = first; i < mCmdCnt; i++) {
+                cmdEntry_t *e = &mCmdQueue[(mCmdHead + i) % CMD_QUEUE_SIZE];
+                if((e->txType == txType) && (e->cmd == cmd))
+                    return;
+            }
+
+            if(CMD_QUEUE_SIZE == mCmdCnt) {
+                // replace the last one if it is less important
+                if(mCmdQueue[(mCmdHead + mCmdCnt - 1) % CMD_QUEUE_SIZE].prio >= prio) {
+                    DPRINTLN(DBG_WARN, F("command queue full, dropped cmd ") + String(cmd));
+                    return;
+                }
+                mCmdCnt--;
+            }
+
+            uint8_t pos = mCmdCnt;
+            for(; pos > first; pos--) {
+                cmdEntry_t *prev = &mCmdQueue[(mCmdHead + pos - 1) % CMD_QUEUE_SIZE];
+                if(prev->prio >= prio)
+                    break;
+                mCmdQueue[(mCmdHead + pos) % CMD_QUEUE_SIZE] = *prev;
+            }
+            cmdEntry_t *e = &mCmdQueue[(mCmdHead + pos) % CMD_QUEUE_SIZE];
+            e->txType = txType;
+            e->cmd    = cmd;
+            e->prio   = prio;
+            mCmdCnt++;
+            DPRINTLN(DBG_INFO, "enqueuedCmd: " + String(cmd));
+        }
+
+        uint8_t getCmdPrio(uint8_t txType, uint8_t cmd) {
+            if(0x15 != txType) // everything else than an info request is a device control
+                return CMD_PRIO_CTRL;
+            switch(cmd) {
+                case AlarmData:
+                case AlarmUpdate:             return CMD_PRIO_ALARM;
+                case RealTimeRunData_Debug:
+                case RealTimeRunData_Reality: return CMD_PRIO_REALTIME;
+                default:                      break;
+            }
+            return CMD_PRIO_INFO;
+        }
+
+        uint8_t    mCalcPos[MAX_CALC_CNT];  // calculated fields in order of evaluation
+        uint64_t   mCalcDeps[MAX_CALC_CNT]; // positions each of them depends on
+        uint8_t    mCalcCnt;
+
+        cmdEntry_t mCmdQueue[CMD_QUEUE_SIZE];
+        uint8_t    mCmdHead;
+        uint8_t    mCmdCnt;
+        bool       mCmdActive;
         void toRadioId(void) {
             DPRINTLN(DBG_VERBOSE, F("hmInverter.h:toRadioId"));
             radioId.u64  = 0ULL;
@@ -499,7 +900,7 @@ class Inverter {
  * The special command 0xff (CMDFF) must be used.
  */
 
-template<class T=float>
+template<class T>
 static T calcYieldTotalCh0(Inverter<> *iv, uint8_t arg0) {
     DPRINTLN(DBG_VERBOSE, F("hmInverter.h:calcYieldTotalCh0"));
     if(NULL != iv) {
@@ -514,7 +915,7 @@ static T calcYieldTotalCh0(Inverter<> *iv, uint8_t arg0) {
     return 0.0;
 }
 
-template<class T=float>
+template<class T>
 static T calcYieldDayCh0(Inverter<> *iv, uint8_t arg0) {
     DPRINTLN(DBG_VERBOSE, F("hmInverter.h:calcYieldDayCh0"));
     if(NULL != iv) {
@@ -529,7 +930,7 @@ static T calcYieldDayCh0(Inverter<> *iv, uint8_t arg0) {
     return 0.0;
 }
 
-template<class T=float>
+template<class T>
 static T calcUdcCh(Inverter<> *iv, uint8_t arg0) {
     DPRINTLN(DBG_VERBOSE, F("hmInverter.h:calcUdcCh"));
     // arg0 = channel of source
@@ -543,7 +944,7 @@ static T calcUdcCh(Inverter<> *iv, uint8_t arg0) {
     return 0.0;
 }
 
-template<class T=float>
+template<class T>
 static T calcPowerDcCh0(Inverter<> *iv, uint8_t arg0) {
     DPRINTLN(DBG_VERBOSE, F("hmInverter.h:calcPowerDcCh0"));
     if(NULL != iv) {
@@ -558,7 +959,7 @@ static T calcPowerDcCh0(Inverter<> *iv, uint8_t arg0) {
     return 0.0;
 }
 
-template<class T=float>
+template<class T>
 static T calcEffiencyCh0(Inverter<> *iv, uint8_t arg0) {
     DPRINTLN(DBG_VERBOSE, F("hmInverter.h:calcEfficiencyCh0"));
     if(NULL != iv) {
@@ -570,21 +971,27 @@ static T calcEffiencyCh0(Inverter<> *iv, uint8_t arg0) {
             pos = iv->getPosByChFld(i, FLD_PDC, rec);
             dcPower += iv->getValue(pos, rec);
         }
-        if(dcPower > 0)
+        if(dcPower > 0) {
+            if(std::is_integral<T>::value)
+                return acPower * 10000 / dcPower; // 0.01 %
             return acPower / dcPower * 100.0f;
+        }
     }
     return 0.0;
 }
 
-template<class T=float>
+template<class T>
 static T calcIrradiation(Inverter<> *iv, uint8_t arg0) {
     DPRINTLN(DBG_VERBOSE, F("hmInverter.h:calcIrradiation"));
     // arg0 = channel
     if(NULL != iv) {
         record_t<> *rec = iv->getRecordStruct(RealTimeRunData_Debug);
         uint8_t pos = iv->getPosByChFld(arg0, FLD_PDC, rec);
-        if(iv->chMaxPwr[arg0-1] > 0)
+        if(iv->chMaxPwr[arg0-1] > 0) {
+            if(std::is_integral<T>::value)
+                return iv->getValue(pos, rec) * 1000 / iv->chMaxPwr[arg0-1]; // 0.1 W -> 0.01 %
             return iv->getValue(pos, rec) / iv->chMaxPwr[arg0-1] * 100.0f;
+        }
     }
     return 0.0;
 }
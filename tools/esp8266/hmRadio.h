@@ -8,7 +8,7 @@
 
 #include "dbg.h"
 #include <RF24.h>
-#include "crc.h"
+#include "hmRadioBase.h"
 #ifndef DISABLE_IRQ
     #if defined(ESP8266) || defined(ESP32)
         #define DISABLE_IRQ noInterrupts()
@@ -24,49 +24,42 @@
 #endif
 //#define CHANNEL_HOP // switch between channels or use static channel to send
 
-#define DEFAULT_RECV_CHANNEL    3
 #define SPI_SPEED               1000000
 
 #define DUMMY_RADIO_ID          ((uint64_t)0xDEADBEEF01ULL)
 
-#define RF_CHANNELS             5
-#define RF_LOOP_CNT             300
+#include "hmChannelHop.h"
 
-#define TX_REQ_INFO         0x15
-#define TX_REQ_DEVCONTROL   0x51
-#define ALL_FRAMES          0x80
-#define SINGLE_FRAME        0x81
+// estimated SPI bytes of the RF24 calls (command + data bytes)
+#define SPI_B_REG           2   // single register write
+#define SPI_B_RMW           4   // register read-modify-write
+#define SPI_B_ADDR          6   // 5 byte address write
+#define SPI_B_LISTEN        8   // start / stop listening (config, status, flush)
 
 const char* const rf24AmpPowerNames[] = {"MIN", "LOW", "HIGH", "MAX"};
 
 
-//-----------------------------------------------------------------------------
-// MACROS
-//-----------------------------------------------------------------------------
-#define CP_U32_LittleEndian(buf, v) ({ \
-    uint8_t *b = buf; \
-    b[0] = ((v >> 24) & 0xff); \
-    b[1] = ((v >> 16) & 0xff); \
-    b[2] = ((v >>  8) & 0xff); \
-    b[3] = ((v      ) & 0xff); \
-})
 
-#define CP_U32_BigEndian(buf, v) ({ \
-    uint8_t *b = buf; \
-    b[3] = ((v >> 24) & 0xff); \
-    b[2] = ((v >> 16) & 0xff); \
-    b[1] = ((v >>  8) & 0xff); \
-    b[0] = ((v      ) & 0xff); \
-})
 
-#define BIT_CNT(x)  ((x)<<3)
+//-----------------------------------------------------------------------------
+// nRF24 register shadow, only changed settings are written to the module
+//-----------------------------------------------------------------------------
+typedef struct {
+    uint8_t ch;
+    rf24_crclength_e crc;
+    bool autoAck;
+    bool dynPld;
+    uint8_t retrDelay;
+    uint8_t retrCnt;
+    uint64_t txAddr;
+} rfCfg_t;
 
 
 //-----------------------------------------------------------------------------
 // HM Radio class
 //-----------------------------------------------------------------------------
 template <class BUFFER, uint8_t IRQ_PIN = DEF_IRQ_PIN, uint8_t CE_PIN = DEF_CE_PIN, uint8_t CS_PIN = DEF_CS_PIN, uint8_t AMP_PWR = RF24_PA_LOW>
-class HmRadio {
+class HmRadio : public HmRadioBase {
     public:
         HmRadio() : mNrf24(CE_PIN, CS_PIN, SPI_SPEED) {
             DPRINT(DBG_VERBOSE, F("hmRadio.h : HmRadio():mNrf24(CE_PIN: "));
@@ -88,9 +81,12 @@ class HmRadio {
             mRxChIdx    = 0; // Start RX with 03
             mRxLoopCnt  = RF_LOOP_CNT;
 
-            mSendCnt       = 0;
+            mSpiBytes      = 0;
+            mLastTxInvId   = 0ULL;
+            memset(mRpdCnt, 0, sizeof(uint32_t) * RF_CHANNELS);
+            memset(mRpdSamples, 0, sizeof(uint32_t) * RF_CHANNELS);
+            mLastTxMillis  = 0;
 
-            mSerialDebug = false;
             mIrqRcvd     = false;
         }
         ~HmRadio() {}
@@ -101,7 +97,6 @@ class HmRadio {
             mBufCtrl = ctrl;
         
 
-            uint32_t dtuSn = 0x87654321;
             uint32_t chipID = 0; // will be filled with last 3 bytes of MAC
             #ifdef ESP32
             uint64_t MAC = ESP.getEfuseMac();
@@ -109,15 +104,7 @@ class HmRadio {
             #else
             chipID = ESP.getChipId();
             #endif
-            if(chipID) {
-                dtuSn = 0x80000000; // the first digit is an 8 for DTU production year 2022, the rest is filled with the ESP chipID in decimal
-                for(int i = 0; i < 7; i++) {
-                    dtuSn |= (chipID % 10) << (i * 4);
-                    chipID /= 10;
-                }
-            }
-            // change the byte order of the DTU serial number and append the required 0x01 at the end
-            DTU_RADIO_ID = ((uint64_t)(((dtuSn >> 24) & 0xFF) | ((dtuSn >> 8) & 0xFF00) | ((dtuSn << 8) & 0xFF0000) | ((dtuSn << 24) & 0xFF000000)) << 8) | 0x01;
+            setDtuRadioId(chipID);
 
             mNrf24.begin(ce, cs);
             mNrf24.setRetries(0, 0);
@@ -134,6 +121,29 @@ class HmRadio {
             // enable only receiving interrupts
             mNrf24.maskIRQ(true, true, false);
 
+            mShadow.ch        = DEFAULT_RECV_CHANNEL;
+            mShadow.crc       = RF24_CRC_16;
+            mShadow.autoAck   = false;
+            mShadow.dynPld    = true;
+            mShadow.retrDelay = 0;
+            mShadow.retrCnt   = 0;
+            mShadow.txAddr    = 0ULL;
+
+            // register profiles of the TX / RX mode switch, only the channel
+            // and the TX address are set per packet
+            mTxProfile.crc       = RF24_CRC_16;
+            mTxProfile.autoAck   = true;
+            mTxProfile.dynPld    = true;
+            mTxProfile.retrDelay = 3;  // 3*250us and 15 loops -> 11.25ms
+            mTxProfile.retrCnt   = 15;
+
+            mRxProfile.crc       = RF24_CRC_DISABLED;
+            mRxProfile.autoAck   = false;
+            mRxProfile.dynPld    = false;
+            mRxProfile.retrDelay = 0;
+            mRxProfile.retrCnt   = 0;
+            mRxProfile.txAddr    = DUMMY_RADIO_ID; // Try to avoid zero payload acks (has no effect)
+
             DPRINT(DBG_INFO, F("RF24 Amp Pwr: RF24_PA_"));
             DPRINTLN(DBG_INFO, String(rf24AmpPowerNames[ampPwr]));
             mNrf24.setPALevel(ampPwr & 0x03);
@@ -151,36 +161,31 @@ class HmRadio {
 
         void loop(void) {
             DISABLE_IRQ;
-            if(mIrqRcvd) {
-                mIrqRcvd = false;
+            bool irqRcvd = mIrqRcvd;
+            mIrqRcvd = false;
+            RESTORE_IRQ;
+
+            if(irqRcvd) {
                 bool tx_ok, tx_fail, rx_ready;
                 mNrf24.whatHappened(tx_ok, tx_fail, rx_ready); // resets the IRQ pin to HIGH
-                RESTORE_IRQ;
                 uint8_t pipe, len;
                 packet_t *p;
                 while(mNrf24.available(&pipe)) {
-                    if(!mBufCtrl->full()) {
-                        p = mBufCtrl->getFront();
-                        p->rxCh = mRfChLst[mRxChIdx];
-                        len = mNrf24.getPayloadSize();
-                        if(len > MAX_RF_PAYLOAD_SIZE)
-                            len = MAX_RF_PAYLOAD_SIZE;
-
-                        mNrf24.read(p->packet, len);
-                        mBufCtrl->pushFront(p);
-                        yield();
-                    }
-                    else
+                    p = mBufCtrl->getFront();
+                    if(NULL == p)
                         break;
+                    p->rxCh = mRfChLst[mRxChIdx];
+                    len = mNrf24.getPayloadSize();
+                    if(len > MAX_RF_PAYLOAD_SIZE)
+                        len = MAX_RF_PAYLOAD_SIZE;
+
+                    mNrf24.read(p->packet, len);
+                    if(!isDuplicate(p->packet))
+                        mBufCtrl->pushFront(p);
+                    yield();
                 }
                 mNrf24.flush_rx(); // drop the packet
             }
-            else
-                RESTORE_IRQ;
-        }
-
-        void enableDebug() {
-            mSerialDebug = true;
         }
 
         void handleIntr(void) {
@@ -195,99 +200,77 @@ class HmRadio {
             return mRfChLst[mTxChIdx];
         }
 
-        void sendControlPacket(uint64_t invId, uint8_t cmd, uint16_t *data) {
-            DPRINTLN(DBG_INFO, F("sendControlPacket cmd: ") + String(cmd));
-            sendCmdPacket(invId, TX_REQ_DEVCONTROL, SINGLE_FRAME, false);
-            uint8_t cnt = 0;
-            mTxBuf[10 + cnt++] = cmd; // cmd -> 0 on, 1 off, 2 restart, 11 active power, 12 reactive power, 13 power factor
-            mTxBuf[10 + cnt++] = 0x00;
-            if(cmd >= ActivePowerContr && cmd <= PFSet) { // ActivePowerContr, ReactivePowerContr, PFSet
-                mTxBuf[10 + cnt++] = ((data[0] * 10) >> 8) & 0xff; // power limit
-                mTxBuf[10 + cnt++] = ((data[0] * 10)     ) & 0xff; // power limit
-                mTxBuf[10 + cnt++] = ((data[1]     ) >> 8) & 0xff; // setting for persistens handlings
-                mTxBuf[10 + cnt++] = ((data[1]     )     ) & 0xff; // setting for persistens handling
+        bool switchRxCh(uint16_t addLoop = 0) {
+            //DPRINTLN(DBG_VERBOSE, F("hmRadio.h:switchRxCh"));
+            mRxLoopCnt += addLoop;
+            if(mRxLoopCnt != 0) {
+                mRxLoopCnt--;
+                // received power detector of the channel we are leaving
+                // (>= -64dBm during the last dwell slot)
+                if(mNrf24.testRPD())
+                    mRpdCnt[mRxChIdx]++;
+                mRpdSamples[mRxChIdx]++;
+                mSpiBytes += SPI_B_REG;
+
+                uint8_t ch = getRxNxtChannel();
+                if(ch != mShadow.ch) {
+                    DISABLE_IRQ;
+                    mNrf24.stopListening();
+                    mNrf24.setChannel(ch);
+                    mNrf24.startListening();
+                    RESTORE_IRQ;
+                    mShadow.ch = ch;
+                    mSpiBytes += (2 * SPI_B_LISTEN) + SPI_B_REG;
+                }
             }
-
-            // crc control data
-            uint16_t crc = ah::crc16(&mTxBuf[10], cnt);
-            mTxBuf[10 + cnt++] = (crc >> 8) & 0xff;
-            mTxBuf[10 + cnt++] = (crc     ) & 0xff;
-            
-            // crc over all
-            mTxBuf[10 + cnt] = ah::crc8(mTxBuf, 10 + cnt);
-
-            sendPacket(invId, mTxBuf, 10 + cnt + 1, true);
+            return (0 == mRxLoopCnt); // receive finished
         }
 
-        void sendTimePacket(uint64_t invId, uint8_t cmd, uint32_t ts, uint16_t alarmMesId) {
-            DPRINTLN(DBG_INFO, F("sendTimePacket"));
-            sendCmdPacket(invId, TX_REQ_INFO, ALL_FRAMES, false);
-            mTxBuf[10] = cmd; // cid
-            mTxBuf[11] = 0x00;
-            CP_U32_LittleEndian(&mTxBuf[12], ts);
-            if (cmd == RealTimeRunData_Debug || cmd == AlarmData ) {
-                mTxBuf[18] = (alarmMesId >> 8) & 0xff;
-                mTxBuf[19] = (alarmMesId     ) & 0xff;
-            }
-            uint16_t crc = ah::crc16(&mTxBuf[10], 14);
-            mTxBuf[24] = (crc >> 8) & 0xff;
-            mTxBuf[25] = (crc     ) & 0xff;
-            mTxBuf[26] = ah::crc8(mTxBuf, 26);
+        // ends the RX window early, e.g. once all fragments are received
+        inline void closeRxWindow(void) {
+            mRxLoopCnt = 0;
+        }
 
-            sendPacket(invId, mTxBuf, 27, true);
+        inline bool rxWindowClosed(void) {
+            return (0 == mRxLoopCnt);
         }
 
-        void sendCmdPacket(uint64_t invId, uint8_t mid, uint8_t pid, bool calcCrc = true) {
-            DPRINTLN(DBG_VERBOSE, F("sendCmdPacket, mid: ") + String(mid, HEX) + F(" pid: ") + String(pid, HEX));
-            memset(mTxBuf, 0, MAX_RF_PAYLOAD_SIZE);
-            mTxBuf[0] = mid; // message id
-            CP_U32_BigEndian(&mTxBuf[1], (invId  >> 8));
-            CP_U32_BigEndian(&mTxBuf[5], (DTU_RADIO_ID >> 8));
-            mTxBuf[9]  = pid;
-            if(calcCrc) {
-                mTxBuf[10] = ah::crc8(mTxBuf, 10);
-                sendPacket(invId, mTxBuf, 11, false);
+        // feeds the adaptive channel selection, rxCh is the channel on which
+        // a valid fragment of inverter invId was received
+        void rxFragment(uint64_t invId, uint8_t rxCh) {
+            for(uint8_t i = 0; i < RF_CHANNELS; i++) {
+                if(mRfChLst[i] == rxCh) {
+                    mHop.rxFragment(invId, i);
+                    break;
+                }
             }
         }
 
-        bool checkPaketCrc(uint8_t buf[], uint8_t *len, uint8_t rxCh) {
-            //DPRINTLN(DBG_INFO, F("hmRadio.h:checkPaketCrc"));
-            *len = (buf[0] >> 2);
-            if(*len > (MAX_RF_PAYLOAD_SIZE - 2))
-                *len = MAX_RF_PAYLOAD_SIZE - 2;
-            for(uint8_t i = 1; i < (*len + 1); i++) {
-                buf[i-1] = (buf[i] << 1) | (buf[i+1] >> 7);
-            }
+        void lostFragments(uint64_t invId, uint8_t cnt) {
+            mHop.lostFragments(invId, cnt);
+        }
 
-            uint8_t crc = ah::crc8(buf, *len-1);
-            bool valid  = (crc == buf[*len-1]);
+        // sizes the channel statistics, once the inverters were added
+        inline void setNumInverters(uint8_t cnt) {
+            mHop.setup(cnt);
+        }
 
-            return valid;
+        inline uint8_t getRfChannel(uint8_t idx) {
+            return mRfChLst[idx % RF_CHANNELS];
         }
 
-        bool switchRxCh(uint16_t addLoop = 0) {
-            //DPRINTLN(DBG_VERBOSE, F("hmRadio.h:switchRxCh"));
-            mRxLoopCnt += addLoop;
-            if(mRxLoopCnt != 0) {
-                mRxLoopCnt--;
-                DISABLE_IRQ;
-                mNrf24.stopListening();
-                mNrf24.setChannel(getRxNxtChannel());
-                mNrf24.startListening();
-                RESTORE_IRQ;
-            }
-            return (0 == mRxLoopCnt); // receive finished
+        // received power detector hits and samples of channel index chIdx
+        void getRpd(uint8_t chIdx, uint32_t *hits, uint32_t *samples) {
+            *hits    = mRpdCnt[chIdx % RF_CHANNELS];
+            *samples = mRpdSamples[chIdx % RF_CHANNELS];
         }
 
-        void dumpBuf(const char *info, uint8_t buf[], uint8_t len) {
-            //DPRINTLN(DBG_VERBOSE, F("hmRadio.h:dumpBuf"));
-            if(NULL != info)
-                DBGPRINT(String(info));
-            for(uint8_t i = 0; i < len; i++) {
-                DHEX(buf[i]);
-                DBGPRINT(" ");
-            }
-            DBGPRINTLN("");
+        // estimated SPI bytes since the last reset
+        uint32_t getSpiBytes(bool reset = false) {
+            uint32_t bytes = mSpiBytes;
+            if(reset)
+                mSpiBytes = 0;
+            return bytes;
         }
 
         bool isChipConnected(void) {
@@ -297,17 +280,22 @@ class HmRadio {
 
 
 
-        uint32_t mSendCnt;
-
-        bool mSerialDebug;
-
     private:
-        void sendPacket(uint64_t invId, uint8_t buf[], uint8_t len, bool clear=false) {
+        void sendPacket(uint64_t invId, uint8_t buf[], uint8_t len, bool clear=false) override {
             //DPRINTLN(DBG_VERBOSE, F("hmRadio.h:sendPacket"));
             //DPRINTLN(DBG_VERBOSE, "sent packet: #" + String(mSendCnt));
             //dumpBuf("SEN ", buf, len);
+            // back to back requests to different inverters (pipelined polling)
+            // are spread over different TX channels
+            uint8_t avoid = 0xff;
+            if((invId != mLastTxInvId) && ((millis() - mLastTxMillis) < RF_BURST_GAP_MS))
+                avoid = mTxChIdx;
+            mTxChIdx = mHop.nextTx(invId, avoid);
+            mTxCh    = mRfChLst[mTxChIdx];
+            mLastTxInvId  = invId;
+            mLastTxMillis = millis();
             if(mSerialDebug) {
-                DPRINT(DBG_INFO, "TX " + String(len) + "B Ch" + String(mRfChLst[mTxChIdx]) + " | ");
+                DPRINT(DBG_INFO, "TX " + String(len) + "B Ch" + String(mTxCh) + " | ");
                 dumpBuf(NULL, buf, len);
             }
 
@@ -317,58 +305,103 @@ class HmRadio {
             if(clear)
                 mRxLoopCnt = RF_LOOP_CNT;
 
-            mNrf24.setChannel(mRfChLst[mTxChIdx]);
-            mTxCh = getTxNxtChannel(); // switch channel for next packet
-            mNrf24.openWritingPipe(invId); // TODO: deprecated
-            mNrf24.setCRCLength(RF24_CRC_16);
-            mNrf24.enableDynamicPayloads();
-            mNrf24.setAutoAck(true);
-            mNrf24.setRetries(3, 15); // 3*250us and 15 loops -> 11.25ms
+            mTxProfile.ch     = mTxCh;
+            mTxProfile.txAddr = invId;
+            applyCfg(&mTxProfile);
             mNrf24.write(buf, len);
 
-            // Try to avoid zero payload acks (has no effect)
-            mNrf24.openWritingPipe(DUMMY_RADIO_ID); // TODO: why dummy radio id?, deprecated
-            mRxChIdx = 0;
-            mNrf24.setChannel(mRfChLst[mRxChIdx]);
-            mNrf24.setAutoAck(false);
-            mNrf24.setRetries(0, 0);
-            mNrf24.disableDynamicPayloads();
-            mNrf24.setCRCLength(RF24_CRC_DISABLED);
+            mRxChIdx = mHop.firstRx();
+            mRxProfile.ch = mRfChLst[mRxChIdx];
+            applyCfg(&mRxProfile);
             mNrf24.startListening();
 
             RESTORE_IRQ;
+            mSpiBytes += (2 * SPI_B_LISTEN) + (1 + len);
             mSendCnt++;
         }
 
-        uint8_t getTxNxtChannel(void) {
+        // writes only the settings of cfg which differ from the shadow. The
+        // nRF24 keeps the CRC enabled while auto ack is on, so auto ack is
+        // switched off before the CRC (RX) and the CRC set before auto ack
+        // is switched on (TX), as in the sequences of the original code
+        void applyCfg(const rfCfg_t *cfg) {
+            if(cfg->ch != mShadow.ch) {
+                mNrf24.setChannel(cfg->ch);
+                mSpiBytes += SPI_B_REG;
+            }
+            if(cfg->txAddr != mShadow.txAddr) {
+                mNrf24.openWritingPipe(cfg->txAddr); // TODO: deprecated
+                mSpiBytes += (2 * SPI_B_ADDR) + SPI_B_REG;
+            }
+            if(cfg->autoAck) {
+                applyCrc(cfg);
+                applyAutoAck(cfg);
+            }
+            else {
+                applyAutoAck(cfg);
+                applyCrc(cfg);
+            }
+            mShadow = *cfg;
+        }
 
-            if(++mTxChIdx >= RF_CHANNELS)
-                mTxChIdx = 0;
-            return mRfChLst[mTxChIdx];
+        // auto ack and retries
+        void applyAutoAck(const rfCfg_t *cfg) {
+            if(cfg->autoAck != mShadow.autoAck) {
+                mNrf24.setAutoAck(cfg->autoAck);
+                mSpiBytes += SPI_B_REG;
+            }
+            if((cfg->retrDelay != mShadow.retrDelay) || (cfg->retrCnt != mShadow.retrCnt)) {
+                mNrf24.setRetries(cfg->retrDelay, cfg->retrCnt);
+                mSpiBytes += SPI_B_REG;
+            }
         }
 
-        uint8_t getRxNxtChannel(void) {
+        // CRC and dynamic payloads, in the order of the direction
+        void applyCrc(const rfCfg_t *cfg) {
+            if(cfg->autoAck && (cfg->crc != mShadow.crc)) {
+                mNrf24.setCRCLength(cfg->crc);
+                mSpiBytes += SPI_B_RMW;
+            }
+            if(cfg->dynPld != mShadow.dynPld) {
+                if(cfg->dynPld)
+                    mNrf24.enableDynamicPayloads();
+                else
+                    mNrf24.disableDynamicPayloads();
+                mSpiBytes += 2 * SPI_B_RMW;
+            }
+            if(!cfg->autoAck && (cfg->crc != mShadow.crc)) {
+                mNrf24.setCRCLength(cfg->crc);
+                mSpiBytes += SPI_B_RMW;
+            }
+        }
 
-            if(++mRxChIdx >= RF_CHANNELS)
-                mRxChIdx = 0;
+        uint8_t getRxNxtChannel(void) {
+            mRxChIdx = mHop.nextRx();
             return mRfChLst[mRxChIdx];
         }
 
-        uint64_t DTU_RADIO_ID;
-
         uint8_t mTxCh;
         uint8_t mTxChIdx;
+        uint64_t mLastTxInvId;
+        uint32_t mLastTxMillis;
 
         uint8_t mRfChLst[RF_CHANNELS];
         
         uint8_t mRxChIdx;
         uint16_t mRxLoopCnt;
 
+        HmChannelHop mHop;
+
+        rfCfg_t mShadow;
+        rfCfg_t mTxProfile;
+        rfCfg_t mRxProfile;
+        uint32_t mSpiBytes;
+
+        uint32_t mRpdCnt[RF_CHANNELS];
+        uint32_t mRpdSamples[RF_CHANNELS];
+
         RF24 mNrf24;
         BUFFER *mBufCtrl;
-        uint8_t mTxBuf[MAX_RF_PAYLOAD_SIZE];
-
-        DevControlCmdType DevControlCmd;
 
         volatile bool mIrqRcvd;
 };
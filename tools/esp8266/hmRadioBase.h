@@ -0,0 +1,216 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HM_RADIO_BASE_H__
+#define __HM_RADIO_BASE_H__
+
+#include "dbg.h"
+#include "crc.h"
+#include "hmDedup.h"
+
+#define DEFAULT_RECV_CHANNEL    3
+
+#define RF_CHANNELS             5
+#define RF_LOOP_CNT             300
+#define RF_BURST_GAP_MS         20  // requests to different inverters within this time use different TX channels
+
+#define TX_REQ_INFO         0x15
+#define TX_REQ_DEVCONTROL   0x51
+#define ALL_FRAMES          0x80
+#define SINGLE_FRAME        0x81
+
+#define FRAGMENT_HDR_LEN    10 // cmd, 2x 4 byte address, packet id
+#define MAX_FRAGMENT_LEN    16 // data bytes of each but the last fragment
+
+
+//-----------------------------------------------------------------------------
+// MACROS
+//-----------------------------------------------------------------------------
+#define CP_U32_LittleEndian(buf, v) ({ \
+    uint8_t *b = buf; \
+    b[0] = ((v >> 24) & 0xff); \
+    b[1] = ((v >> 16) & 0xff); \
+    b[2] = ((v >>  8) & 0xff); \
+    b[3] = ((v      ) & 0xff); \
+})
+
+#define CP_U32_BigEndian(buf, v) ({ \
+    uint8_t *b = buf; \
+    b[3] = ((v >> 24) & 0xff); \
+    b[2] = ((v >> 16) & 0xff); \
+    b[1] = ((v >>  8) & 0xff); \
+    b[0] = ((v      ) & 0xff); \
+})
+
+#define BIT_CNT(x)  ((x)<<3)
+
+
+//-----------------------------------------------------------------------------
+// HM Radio base class
+//-----------------------------------------------------------------------------
+// Builds and decodes the frames of the Hoymiles protocol, the transport is
+// implemented by the derived class (nRF24 module or simulation).
+class HmRadioBase {
+    public:
+        HmRadioBase() {
+            DTU_RADIO_ID = 0ULL;
+            mSendCnt     = 0;
+            mSerialDebug = false;
+            mDedup       = NULL;
+        }
+        virtual ~HmRadioBase() {}
+
+        void enableDebug() {
+            mSerialDebug = true;
+        }
+
+        // received copies of the same frame are dropped by dedup
+        void setDedup(HmDedup *dedup) {
+            mDedup = dedup;
+        }
+
+        void sendControlPacket(uint64_t invId, uint8_t cmd, uint16_t *data) {
+            DPRINTLN(DBG_INFO, F("sendControlPacket cmd: ") + String(cmd));
+            sendCmdPacket(invId, TX_REQ_DEVCONTROL, SINGLE_FRAME, false);
+            uint8_t cnt = 0;
+            mTxBuf[10 + cnt++] = cmd; // cmd -> 0 on, 1 off, 2 restart, 11 active power, 12 reactive power, 13 power factor
+            mTxBuf[10 + cnt++] = 0x00;
+            if(cmd >= ActivePowerContr && cmd <= PFSet) { // ActivePowerContr, ReactivePowerContr, PFSet
+                mTxBuf[10 + cnt++] = ((data[0] * 10) >> 8) & 0xff; // power limit
+                mTxBuf[10 + cnt++] = ((data[0] * 10)     ) & 0xff; // power limit
+                mTxBuf[10 + cnt++] = ((data[1]     ) >> 8) & 0xff; // setting for persistens handlings
+                mTxBuf[10 + cnt++] = ((data[1]     )     ) & 0xff; // setting for persistens handling
+            }
+
+            // crc control data
+            uint16_t crc = ah::crc16(&mTxBuf[10], cnt);
+            mTxBuf[10 + cnt++] = (crc >> 8) & 0xff;
+            mTxBuf[10 + cnt++] = (crc     ) & 0xff;
+            
+            // crc over all
+            mTxBuf[10 + cnt] = ah::crc8(mTxBuf, 10 + cnt);
+
+            sendPacket(invId, mTxBuf, 10 + cnt + 1, true);
+        }
+
+        void sendTimePacket(uint64_t invId, uint8_t cmd, uint32_t ts, uint16_t alarmMesId) {
+            DPRINTLN(DBG_INFO, F("sendTimePacket"));
+            sendCmdPacket(invId, TX_REQ_INFO, ALL_FRAMES, false);
+            mTxBuf[10] = cmd; // cid
+            mTxBuf[11] = 0x00;
+            CP_U32_LittleEndian(&mTxBuf[12], ts);
+            if (cmd == RealTimeRunData_Debug || cmd == AlarmData ) {
+                mTxBuf[18] = (alarmMesId >> 8) & 0xff;
+                mTxBuf[19] = (alarmMesId     ) & 0xff;
+            }
+            uint16_t crc = ah::crc16(&mTxBuf[10], 14);
+            mTxBuf[24] = (crc >> 8) & 0xff;
+            mTxBuf[25] = (crc     ) & 0xff;
+            mTxBuf[26] = ah::crc8(mTxBuf, 26);
+
+            sendPacket(invId, mTxBuf, 27, true);
+        }
+
+        void sendCmdPacket(uint64_t invId, uint8_t mid, uint8_t pid, bool calcCrc = true) {
+            DPRINTLN(DBG_VERBOSE, F("sendCmdPacket, mid: ") + String(mid, HEX) + F(" pid: ") + String(pid, HEX));
+            memset(mTxBuf, 0, MAX_RF_PAYLOAD_SIZE);
+            mTxBuf[0] = mid; // message id
+            CP_U32_BigEndian(&mTxBuf[1], (invId  >> 8));
+            CP_U32_BigEndian(&mTxBuf[5], (DTU_RADIO_ID >> 8));
+            mTxBuf[9]  = pid;
+            if(calcCrc) {
+                mTxBuf[10] = ah::crc8(mTxBuf, 10);
+                sendPacket(invId, mTxBuf, 11, false);
+            }
+        }
+
+        bool checkPaketCrc(uint8_t buf[], uint8_t *len, uint8_t rxCh) {
+            //DPRINTLN(DBG_INFO, F("hmRadio.h:checkPaketCrc"));
+            *len = (buf[0] >> 2);
+            if(*len > (MAX_RF_PAYLOAD_SIZE - 2))
+                *len = MAX_RF_PAYLOAD_SIZE - 2;
+            for(uint8_t i = 1; i < (*len + 1); i++) {
+                buf[i-1] = (buf[i] << 1) | (buf[i+1] >> 7);
+            }
+
+            uint8_t crc = ah::crc8(buf, *len-1);
+            bool valid  = (crc == buf[*len-1]);
+
+            return valid;
+        }
+
+        // decodes only the header of a raw frame to hdr, the raw buffer stays
+        // untouched; returns the frame length
+        uint8_t getPacketHeader(uint8_t raw[], uint8_t hdr[]) {
+            uint8_t len = (raw[0] >> 2);
+            if(len > (MAX_RF_PAYLOAD_SIZE - 2))
+                len = MAX_RF_PAYLOAD_SIZE - 2;
+            for(uint8_t i = 0; i < FRAGMENT_HDR_LEN; i++) {
+                hdr[i] = (raw[i+1] << 1) | (raw[i+2] >> 7);
+            }
+            return len;
+        }
+
+        // decodes the fragment data of a raw frame straight to its final
+        // position dst (len - FRAGMENT_HDR_LEN - 1 bytes), hdr must be the
+        // result of getPacketHeader
+        bool getFragment(uint8_t raw[], uint8_t len, uint8_t hdr[], uint8_t dst[]) {
+            if(len <= (FRAGMENT_HDR_LEN + 1))
+                return false;
+            uint8_t dataLen = len - FRAGMENT_HDR_LEN - 1;
+            for(uint8_t i = FRAGMENT_HDR_LEN + 1; i < len; i++) {
+                *(dst++) = (raw[i] << 1) | (raw[i+1] >> 7);
+            }
+
+            uint8_t crc = ah::crc8(hdr, FRAGMENT_HDR_LEN);
+            crc = ah::crc8(dst - dataLen, dataLen, crc);
+            return (crc == (uint8_t)((raw[len] << 1) | (raw[len+1] >> 7)));
+        }
+
+        void dumpBuf(const char *info, uint8_t buf[], uint8_t len) {
+            //DPRINTLN(DBG_VERBOSE, F("hmRadio.h:dumpBuf"));
+            if(NULL != info)
+                DBGPRINT(String(info));
+            for(uint8_t i = 0; i < len; i++) {
+                DHEX(buf[i]);
+                DBGPRINT(" ");
+            }
+            DBGPRINTLN("");
+        }
+
+        inline uint64_t getDtuRadioId(void) {
+            return DTU_RADIO_ID;
+        }
+
+        uint32_t mSendCnt;
+
+        bool mSerialDebug;
+
+    protected:
+        virtual void sendPacket(uint64_t invId, uint8_t buf[], uint8_t len, bool clear=false) = 0;
+
+        void setDtuRadioId(uint32_t chipID) {
+            uint32_t dtuSn = 0x87654321;
+            if(chipID) {
+                dtuSn = 0x80000000; // the first digit is an 8 for DTU production year 2022, the rest is filled with the ESP chipID in decimal
+                for(int i = 0; i < 7; i++) {
+                    dtuSn |= (chipID % 10) << (i * 4);
+                    chipID /= 10;
+                }
+            }
+            // change the byte order of the DTU serial number and append the required 0x01 at the end
+            DTU_RADIO_ID = ((uint64_t)(((dtuSn >> 24) & 0xFF) | ((dtuSn >> 8) & 0xFF00) | ((dtuSn << 8) & 0xFF0000) | ((dtuSn << 24) & 0xFF000000)) << 8) | 0x01;
+        }
+
+        inline bool isDuplicate(uint8_t raw[]) {
+            return (NULL != mDedup) && mDedup->isDuplicate(raw);
+        }
+
+        uint64_t DTU_RADIO_ID;
+        uint8_t mTxBuf[MAX_RF_PAYLOAD_SIZE];
+        HmDedup *mDedup;
+};
+
+#endif /*__HM_RADIO_BASE_H__*/
@@ -0,0 +1,101 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HM_RX_RADIO_H__
+#define __HM_RX_RADIO_H__
+
+#include "dbg.h"
+#include <RF24.h>
+#include "hmDedup.h"
+
+//-----------------------------------------------------------------------------
+// HM RX Radio class
+//-----------------------------------------------------------------------------
+// Additional nRF24 module which never transmits. It stays parked in RX on a
+// single channel and is polled (no IRQ pin), received frames are pushed to
+// the packet buffer of the main radio. That way fragments are captured on
+// several channels at once and during the TX / RX turnaround of the main
+// radio.
+template <class BUFFER>
+class HmRxRadio {
+    public:
+        HmRxRadio() : mNrf24(SPI_SPEED) {
+            mRxCh      = DEFAULT_RECV_CHANNEL;
+            mRxCnt     = 0;
+            mConnected = false;
+            mDedup     = NULL;
+        }
+        ~HmRxRadio() {}
+
+        void setup(BUFFER *ctrl, HmDedup *dedup, uint64_t dtuRadioId, uint8_t rxCh, uint8_t ce, uint8_t cs) {
+            DPRINTLN(DBG_VERBOSE, F("hmRxRadio.h:setup"));
+            mBufCtrl = ctrl;
+            mDedup   = dedup;
+            mRxCh    = rxCh;
+
+            mNrf24.begin(ce, cs);
+            mNrf24.setRetries(0, 0);
+            mNrf24.setChannel(mRxCh);
+            mNrf24.setDataRate(RF24_250KBPS);
+            mNrf24.setCRCLength(RF24_CRC_DISABLED);
+            mNrf24.setAutoAck(false);
+            mNrf24.setPayloadSize(MAX_RF_PAYLOAD_SIZE);
+            mNrf24.setAddressWidth(5);
+            mNrf24.openReadingPipe(1, dtuRadioId);
+            mNrf24.disableDynamicPayloads();
+            mNrf24.maskIRQ(true, true, true);
+            mNrf24.startListening();
+
+            mConnected = mNrf24.isChipConnected();
+            if(!mConnected) {
+                DPRINT(DBG_WARN, F("WARNING! RX radio (CE: "));
+                DPRINT(DBG_WARN, String(ce));
+                DPRINTLN(DBG_WARN, F(") can't be reached, check the wiring"));
+            }
+            else {
+                DPRINT(DBG_INFO, F("RX radio parked on Ch"));
+                DPRINTLN(DBG_INFO, String(mRxCh));
+            }
+        }
+
+        void loop(void) {
+            if(!mConnected)
+                return;
+            packet_t *p;
+            while(mNrf24.available()) {
+                p = mBufCtrl->getFront();
+                if(NULL == p) {
+                    mNrf24.flush_rx(); // drop the packet
+                    break;
+                }
+                p->rxCh = mRxCh;
+                mNrf24.read(p->packet, MAX_RF_PAYLOAD_SIZE);
+                mRxCnt++;
+                if((NULL != mDedup) && mDedup->isDuplicate(p->packet))
+                    continue; // slot is reused for the next frame
+                mBufCtrl->pushFront(p);
+                yield();
+            }
+        }
+
+        inline uint8_t getChannel(void) {
+            return mRxCh;
+        }
+
+        bool isChipConnected(void) {
+            return mNrf24.isChipConnected();
+        }
+
+        uint32_t mRxCnt;
+
+    private:
+        RF24 mNrf24;
+        BUFFER *mBufCtrl;
+        HmDedup *mDedup;
+        uint8_t mRxCh;
+        bool mConnected;
+};
+
+#endif /*__HM_RX_RADIO_H__*/
@@ -0,0 +1,355 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HM_SIM_RADIO_H__
+#define __HM_SIM_RADIO_H__
+
+#include <cstdlib>
+#include "hmRadioBase.h"
+#include "hmDefines.h"
+
+#define SIM_MAX_INVERTERS       MAX_NUM_INVERTERS
+#define SIM_QUEUE_LEN           32  // frames 'in the air'
+#define SIM_MAX_PAYLOAD_LEN     (MAX_PAYLOAD_ENTRIES * MAX_FRAGMENT_LEN)
+
+// default channel model, can be changed per channel with setChannelModel()
+#define SIM_DEF_LOSS_PCT        5   // frames lost
+#define SIM_DEF_DUP_PCT         2   // frames received twice
+#define SIM_DEF_BIT_ERR_PCT     1   // frames with a flipped bit
+#define SIM_DEF_LATENCY_MIN_MS  2   // delay between request and answer
+#define SIM_DEF_LATENCY_MAX_MS  20
+
+typedef struct {
+    uint8_t lossPct;
+    uint8_t dupPct;
+    uint8_t bitErrPct;
+} simChModel_t;
+
+typedef struct {
+    uint64_t radioId;
+    uint8_t  type;
+    uint8_t  cmd;                           // command of the last request
+    uint8_t  pyld[SIM_MAX_PAYLOAD_LEN + 2]; // last payload incl. crc16
+    uint8_t  pyldLen;
+    uint8_t  fragments;
+} simInverter_t;
+
+typedef struct {
+    uint32_t due;
+    uint8_t  rxCh;
+    uint8_t  raw[MAX_RF_PAYLOAD_SIZE];
+} simFrame_t;
+
+
+//-----------------------------------------------------------------------------
+// HM simulated radio class
+//-----------------------------------------------------------------------------
+// Software replacement of HmRadio, selected with SIM_RADIO (config.h). The
+// requests are answered by simulated inverters, their payloads are built
+// from the assignment tables (hmDefines.h). The answers are put into the
+// packet buffer in the raw (shifted) format of the nRF24 module, every RX
+// channel applies its own loss, duplication and bit error rate.
+template <class BUFFER>
+class HmSimRadio : public HmRadioBase {
+    public:
+        HmSimRadio() {
+            mRfChLst[0] = 03;
+            mRfChLst[1] = 23;
+            mRfChLst[2] = 40;
+            mRfChLst[3] = 61;
+            mRfChLst[4] = 75;
+
+            for(uint8_t i = 0; i < RF_CHANNELS; i++)
+                setChannelModel(i, SIM_DEF_LOSS_PCT, SIM_DEF_DUP_PCT, SIM_DEF_BIT_ERR_PCT);
+            setLatency(SIM_DEF_LATENCY_MIN_MS, SIM_DEF_LATENCY_MAX_MS);
+
+            mNumInv    = 0;
+            mQueueFill = 0;
+            mRxChIdx   = 0;
+            mRxLoopCnt = RF_LOOP_CNT;
+
+            mFrmCnt    = 0;
+            mLostCnt   = 0;
+            mDupCnt    = 0;
+            mBitErrCnt = 0;
+        }
+        ~HmSimRadio() {}
+
+        void setup(BUFFER *ctrl, uint8_t ampPwr = 0, uint8_t irq = 0, uint8_t ce = 0, uint8_t cs = 0) {
+            DPRINTLN(DBG_INFO, F("hmSimRadio.h:setup, radio is simulated"));
+            mBufCtrl = ctrl;
+            setDtuRadioId(0x123456);
+        }
+
+        // moves the frames which are due to the packet buffer
+        void loop(void) {
+            uint32_t now = millis();
+            for(uint8_t i = 0; i < mQueueFill;) {
+                if((int32_t)(now - mQueue[i].due) >= 0) {
+                    packet_t *p = mBufCtrl->getFront();
+                    if(NULL == p)
+                        break;
+                    p->rxCh = mQueue[i].rxCh;
+                    memcpy(p->packet, mQueue[i].raw, MAX_RF_PAYLOAD_SIZE);
+                    if(!isDuplicate(p->packet))
+                        mBufCtrl->pushFront(p);
+                    mQueue[i] = mQueue[--mQueueFill];
+                }
+                else
+                    i++;
+            }
+        }
+
+        void handleIntr(void) {}
+
+        // the simulated inverter type can't be derived from the radio id
+        void addInverter(uint64_t radioId, uint8_t type) {
+            if(mNumInv >= SIM_MAX_INVERTERS)
+                return;
+            memset(&mInv[mNumInv], 0, sizeof(simInverter_t));
+            mInv[mNumInv].radioId = radioId;
+            mInv[mNumInv].type    = type;
+            mNumInv++;
+        }
+
+        void setChannelModel(uint8_t chIdx, uint8_t lossPct, uint8_t dupPct, uint8_t bitErrPct) {
+            if(chIdx >= RF_CHANNELS)
+                return;
+            mChModel[chIdx].lossPct   = lossPct;
+            mChModel[chIdx].dupPct    = dupPct;
+            mChModel[chIdx].bitErrPct = bitErrPct;
+        }
+
+        void setLatency(uint16_t minMs, uint16_t maxMs) {
+            mLatencyMin = minMs;
+            mLatencyMax = (maxMs < minMs) ? minMs : maxMs;
+        }
+
+        uint8_t setDefaultChannels(void) {
+            mRxChIdx = 0;
+            return mRfChLst[2];
+        }
+
+        bool switchRxCh(uint16_t addLoop = 0) {
+            mRxLoopCnt += addLoop;
+            if(mRxLoopCnt != 0) {
+                mRxLoopCnt--;
+                mRxChIdx = (mRxChIdx + 1) % RF_CHANNELS;
+            }
+            return (0 == mRxLoopCnt); // receive finished
+        }
+
+        inline void closeRxWindow(void) {
+            mRxLoopCnt = 0;
+        }
+
+        inline bool rxWindowClosed(void) {
+            return (0 == mRxLoopCnt);
+        }
+
+        void rxFragment(uint64_t invId, uint8_t rxCh) {}
+        void lostFragments(uint64_t invId, uint8_t cnt) {}
+
+        void getRpd(uint8_t chIdx, uint32_t *hits, uint32_t *samples) {
+            *hits    = 0;
+            *samples = 0;
+        }
+
+        uint32_t getSpiBytes(bool reset = false) {
+            return 0;
+        }
+
+        inline uint8_t getRfChannel(uint8_t idx) {
+            return mRfChLst[idx % RF_CHANNELS];
+        }
+
+        bool isChipConnected(void) {
+            return true;
+        }
+
+        uint32_t mFrmCnt;    // frames sent by the simulated inverters
+        uint32_t mLostCnt;
+        uint32_t mDupCnt;
+        uint32_t mBitErrCnt;
+
+    private:
+        void sendPacket(uint64_t invId, uint8_t buf[], uint8_t len, bool clear=false) override {
+            if(mSerialDebug) {
+                DPRINT(DBG_INFO, "TX " + String(len) + "B SIM | ");
+                dumpBuf(NULL, buf, len);
+            }
+            if(clear)
+                mRxLoopCnt = RF_LOOP_CNT;
+            mSendCnt++;
+
+            simInverter_t *inv = getInverter(invId);
+            if((NULL == inv) || (ah::crc8(buf, len - 1) != buf[len - 1]))
+                return;
+
+            uint8_t pid = buf[9];
+            if(TX_REQ_DEVCONTROL == buf[0]) {
+                uint8_t data[6] = {0};
+                data[2] = buf[10]; // accept the command
+                queueFrame(inv, TX_REQ_DEVCONTROL + ALL_FRAMES, ALL_FRAMES + 1, data, 6);
+            }
+            else if(TX_REQ_INFO == buf[0]) {
+                if(ALL_FRAMES == pid) { // new request, answer with all fragments
+                    buildPayload(inv, buf[10]);
+                    for(uint8_t i = 1; i <= inv->fragments; i++)
+                        queueFragment(inv, i);
+                }
+                else if((pid & 0x7f) <= inv->fragments) // retransmit of a single fragment
+                    queueFragment(inv, pid & 0x7f);
+            }
+        }
+
+        simInverter_t *getInverter(uint64_t radioId) {
+            for(uint8_t i = 0; i < mNumInv; i++) {
+                if(mInv[i].radioId == radioId)
+                    return &mInv[i];
+            }
+            return NULL;
+        }
+
+        void buildPayload(simInverter_t *inv, uint8_t cmd) {
+            const byteAssign_t *assign;
+            uint8_t listLen, pyldLen;
+            switch(cmd) {
+                case RealTimeRunData_Debug:
+                    if(INV_TYPE_1CH == inv->type)      { assign = hm1chAssignment; listLen = HM1CH_LIST_LEN; pyldLen = HM1CH_PAYLOAD_LEN; }
+                    else if(INV_TYPE_2CH == inv->type) { assign = hm2chAssignment; listLen = HM2CH_LIST_LEN; pyldLen = HM2CH_PAYLOAD_LEN; }
+                    else                               { assign = hm4chAssignment; listLen = HM4CH_LIST_LEN; pyldLen = HM4CH_PAYLOAD_LEN; }
+                    break;
+                case InverterDevInform_All:
+                    assign = InfoAssignment; listLen = HMINFO_LIST_LEN; pyldLen = HMINFO_PAYLOAD_LEN;
+                    break;
+                case SystemConfigPara:
+                    assign = SystemConfigParaAssignment; listLen = HMSYSTEM_LIST_LEN; pyldLen = HMSYSTEM_PAYLOAD_LEN;
+                    break;
+                case AlarmData:
+                    assign = AlarmDataAssignment; listLen = HMALARMDATA_LIST_LEN; pyldLen = 14;
+                    break;
+                default:
+                    assign = NULL; listLen = 0; pyldLen = 14;
+                    break;
+            }
+
+            inv->cmd = cmd;
+            memset(inv->pyld, 0, sizeof(inv->pyld));
+            for(uint8_t i = 0; i < listLen; i++) {
+                if(CMD_CALC == assign[i].div)
+                    continue;
+                uint32_t val = getSimValue(assign[i].fieldId, assign[i].ch) * assign[i].div / 10;
+                for(uint8_t b = 0; b < assign[i].num; b++)
+                    inv->pyld[assign[i].start + b] = (val >> (8 * (assign[i].num - 1 - b))) & 0xff;
+            }
+            uint16_t crc = ah::crc16(inv->pyld, pyldLen);
+            inv->pyld[pyldLen]     = (crc >> 8) & 0xff;
+            inv->pyld[pyldLen + 1] = (crc     ) & 0xff;
+            inv->pyldLen   = pyldLen + 2;
+            inv->fragments = (inv->pyldLen + MAX_FRAGMENT_LEN - 1) / MAX_FRAGMENT_LEN;
+        }
+
+        // plausible values (x10) with some movement over time
+        uint32_t getSimValue(uint8_t fld, uint8_t ch) {
+            uint32_t t = (millis() / 1000) % 60;
+            switch(fld) {
+                case FLD_UDC:    return 325 + ch;
+                case FLD_IDC:    return 81 + t;
+                case FLD_PDC:    return 2630 + (t * 30);
+                case FLD_YD:     return 12000 + (t * 10);
+                case FLD_YT:     return 3456;
+                case FLD_UAC:    return 2301;
+                case FLD_IAC:    return 11;
+                case FLD_PAC:    return 2500 + (t * 25);
+                case FLD_F:      return 500;
+                case FLD_T:      return 352;
+                case FLD_PF:     return 10;
+                case FLD_FW_VERSION:    return 100140;
+                case FLD_FW_BUILD_YEAR: return 20220;
+                case FLD_ACT_ACTIVE_PWR_LIMIT: return 1000;
+                default:         return 0;
+            }
+        }
+
+        void queueFragment(simInverter_t *inv, uint8_t frag) {
+            uint8_t pos = (frag - 1) * MAX_FRAGMENT_LEN;
+            uint8_t len = inv->pyldLen - pos;
+            if(len > MAX_FRAGMENT_LEN)
+                len = MAX_FRAGMENT_LEN;
+            uint8_t pid = (frag == inv->fragments) ? (ALL_FRAMES | frag) : frag;
+            queueFrame(inv, TX_REQ_INFO + ALL_FRAMES, pid, &inv->pyld[pos], len);
+        }
+
+        // builds the frame and applies the channel model
+        void queueFrame(simInverter_t *inv, uint8_t mid, uint8_t pid, uint8_t data[], uint8_t dataLen) {
+            uint8_t frm[MAX_RF_PAYLOAD_SIZE];
+            uint8_t len = FRAGMENT_HDR_LEN + dataLen + 1;
+            frm[0] = mid;
+            CP_U32_BigEndian(&frm[1], (inv->radioId >> 8));
+            CP_U32_BigEndian(&frm[5], (DTU_RADIO_ID >> 8));
+            frm[9] = pid;
+            memcpy(&frm[FRAGMENT_HDR_LEN], data, dataLen);
+            frm[len - 1] = ah::crc8(frm, len - 1);
+            mFrmCnt++;
+
+            uint8_t chIdx = rand() % RF_CHANNELS;
+            simChModel_t *m = &mChModel[chIdx];
+            if((rand() % 100) < m->lossPct) {
+                mLostCnt++;
+                return;
+            }
+            uint8_t cnt = 1;
+            if((rand() % 100) < m->dupPct) {
+                mDupCnt++;
+                cnt = 2;
+            }
+
+            for(uint8_t i = 0; i < cnt; i++) {
+                if(mQueueFill >= SIM_QUEUE_LEN) {
+                    mLostCnt++;
+                    return;
+                }
+                simFrame_t *f = &mQueue[mQueueFill++];
+                f->due  = millis() + mLatencyMin + (rand() % (mLatencyMax - mLatencyMin + 1));
+                f->rxCh = mRfChLst[chIdx];
+                shift(frm, len, f->raw);
+                if((rand() % 100) < m->bitErrPct) {
+                    mBitErrCnt++;
+                    uint8_t bit = rand() % BIT_CNT(len);
+                    f->raw[1 + (bit >> 3)] ^= (1 << (bit & 0x07));
+                }
+            }
+        }
+
+        // nRF24 packet control field (length, pid, no ack) in front of the
+        // frame, the frame starts with the 2nd bit of raw[1]
+        void shift(uint8_t frm[], uint8_t len, uint8_t raw[]) {
+            memset(raw, 0, MAX_RF_PAYLOAD_SIZE);
+            raw[0] = (len << 2);
+            for(uint8_t i = 0; i < len; i++) {
+                raw[i+1] |= (frm[i] >> 1);
+                raw[i+2] |= (frm[i] << 7);
+            }
+        }
+
+        uint8_t mRfChLst[RF_CHANNELS];
+        uint8_t mRxChIdx;
+        uint16_t mRxLoopCnt;
+
+        simChModel_t mChModel[RF_CHANNELS];
+        uint16_t mLatencyMin;
+        uint16_t mLatencyMax;
+
+        simInverter_t mInv[SIM_MAX_INVERTERS];
+        uint8_t mNumInv;
+
+        simFrame_t mQueue[SIM_QUEUE_LEN];
+        uint8_t mQueueFill;
+
+        BUFFER *mBufCtrl;
+};
+
+#endif /*__HM_SIM_RADIO_H__*/
@@ -7,23 +7,40 @@
 #define __HM_SYSTEM_H__
 
 #include "hmInverter.h"
-#include "hmRadio.h"
-#include "CircularBuffer.h"
-
-typedef CircularBuffer<packet_t, PACKET_BUFFER_SIZE> BufferType;
+#include "SpscRing.h"
+#ifdef SIM_RADIO
+    #include "hmSimRadio.h"
+    #undef NUM_RX_RADIOS
+    #define NUM_RX_RADIOS   0
+#else
+    #include "hmRadio.h"
+    #include "hmRxRadio.h"
+#endif
+
+typedef SpscRing<packet_t, PACKET_BUFFER_SIZE> BufferType;
+#ifdef SIM_RADIO
+typedef HmSimRadio<BufferType> RadioType;
+#else
 typedef HmRadio<BufferType> RadioType;
+#endif
 
-template <uint8_t MAX_INVERTER=3, class RADIO = RadioType, class BUFFER = BufferType, class INVERTERTYPE=Inverter<float>>
+template <uint8_t MAX_INVERTER=3, class RADIO = RadioType, class BUFFER = BufferType, class INVERTERTYPE=Inverter<>>
 class HmSystem {
     public:
         typedef RADIO RadioType;
         RadioType Radio;
         typedef BUFFER BufferType;
         BufferType BufCtrl;
+        HmDedup Dedup;
+        #if (NUM_RX_RADIOS > 0)
+        HmRxRadio<BUFFER> RxRadio[NUM_RX_RADIOS];
+        #endif
         //DevControlCmdType DevControlCmd;        
 
         HmSystem() {
             mNumInv = 0;
+            memset(mInverter, 0, sizeof(INVERTERTYPE *) * MAX_INVERTER);
+            memset(mIdx, 0, INV_IDX_SIZE);
         }
         ~HmSystem() {
             // TODO: cleanup
@@ -31,10 +48,28 @@ class HmSystem {
 
         void setup() {
             Radio.setup(&BufCtrl);
+            Radio.setDedup(&Dedup);
+            #ifndef SIM_RADIO
+            Radio.setNumInverters(mNumInv); // the inverters were added before
+            #endif
+            setupRxRadios();
         }
 
         void setup(uint8_t ampPwr, uint8_t irqPin, uint8_t cePin, uint8_t csPin) {
             Radio.setup(&BufCtrl, ampPwr, irqPin, cePin, csPin);
+            Radio.setDedup(&Dedup);
+            #ifndef SIM_RADIO
+            Radio.setNumInverters(mNumInv); // the inverters were added before
+            #endif
+            setupRxRadios();
+        }
+
+        void loop(void) {
+            Radio.loop();
+            #if (NUM_RX_RADIOS > 0)
+            for(uint8_t i = 0; i < NUM_RX_RADIOS; i++)
+                RxRadio[i].loop();
+            #endif
         }
 
         INVERTERTYPE *addInverter(const char *name, uint64_t serial, uint16_t chMaxPwr[]) {
@@ -43,7 +78,9 @@ class HmSystem {
                 DPRINT(DBG_WARN, F("max number of inverters reached!"));
                 return NULL;
             }
-            INVERTERTYPE *p = &mInverter[mNumInv];
+            if(NULL == mInverter[mNumInv])
+                mInverter[mNumInv] = new INVERTERTYPE();
+            INVERTERTYPE *p = mInverter[mNumInv];
             p->id         = mNumInv;
             p->serial.u64 = serial;
             memcpy(p->chMaxPwr, chMaxPwr, (4*2));
@@ -64,37 +101,72 @@ class HmSystem {
                 DPRINTLN(DBG_ERROR, F("inverter type can't be detected!"));
 
             p->init();
+            #ifdef SIM_RADIO
+            Radio.addInverter(p->radioId.u64, p->type);
+            #endif
             uint8_t len   = (uint8_t)strlen(name);
             strncpy(p->name, name, (len > MAX_NAME_LENGTH) ? MAX_NAME_LENGTH : len);
 
             mNumInv ++;
+            addToIndex(p);
             return p;
         }
 
+        // buf: 4 byte address as transmitted (MSB first)
         INVERTERTYPE *findInverter(uint8_t buf[]) {
             DPRINTLN(DBG_VERBOSE, F("hmSystem.h:findInverter"));
-            INVERTERTYPE *p;
-            for(uint8_t i = 0; i < mNumInv; i++) {
-                p = &mInverter[i];
-                if((p->serial.b[3] == buf[0])
-                    && (p->serial.b[2] == buf[1])
-                    && (p->serial.b[1] == buf[2])
-                    && (p->serial.b[0] == buf[3]))
-                    return p;
+            uint32_t addr = ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) | ((uint32_t)buf[2] << 8) | buf[3];
+            for(uint8_t i = 0, h = getHash(addr); i < INV_IDX_SIZE; i++, h = (h + 1) & (INV_IDX_SIZE - 1)) {
+                if(0 == mIdx[h])
+                    break;
+                INVERTERTYPE *p = mInverter[mIdx[h] - 1];
+                if((uint32_t)p->serial.u64 == addr)
+                    return isActive(p) ? p : NULL;
             }
             return NULL;
         }
 
+        // rebuilds the address index, needed after serial numbers were changed.
+        // Slots of getSlot() aren't indexed, their state isn't allocated yet
+        void rebuildIndex(void) {
+            memset(mIdx, 0, INV_IDX_SIZE);
+            for(uint8_t i = 0; i < mNumInv; i++) {
+                if(NULL != mInverter[i])
+                    addToIndex(mInverter[i]);
+            }
+        }
+
+        // added by addInverter() (not just configured on the setup page)
+        inline bool isActive(INVERTERTYPE *p) {
+            return (p->id < mNumInv) && p->initialized;
+        }
+
         INVERTERTYPE *getInverterByPos(uint8_t pos, bool check = true) {
             DPRINTLN(DBG_VERBOSE, F("hmSystem.h:getInverterByPos"));
-            if(pos >= MAX_INVERTER)
+            if((pos >= MAX_INVERTER) || (NULL == mInverter[pos]))
                 return NULL;
-            else if((mInverter[pos].initialized && mInverter[pos].serial.u64 != 0ULL) || false == check)
-                return &mInverter[pos];
+            else if((mInverter[pos]->initialized && mInverter[pos]->serial.u64 != 0ULL) || false == check)
+                return mInverter[pos];
             else
                 return NULL;
         }
 
+        // inverter object of a configuration slot, an empty one is allocated
+        // if the slot is not used yet (it becomes active after a reboot)
+        INVERTERTYPE *getSlot(uint8_t pos) {
+            if(pos >= MAX_INVERTER)
+                return NULL;
+            if(NULL == mInverter[pos]) {
+                mInverter[pos] = new INVERTERTYPE();
+                mInverter[pos]->id = pos;
+                memset(mInverter[pos]->name, 0, MAX_NAME_LENGTH);
+                memset(mInverter[pos]->chName, 0, MAX_NAME_LENGTH * 4);
+                memset(mInverter[pos]->chMaxPwr, 0, 4 * 2);
+                mInverter[pos]->serial.u64 = 0ULL;
+            }
+            return mInverter[pos];
+        }
+
         uint8_t getNumInverters(void) {
             DPRINTLN(DBG_VERBOSE, F("hmSystem.h:getNumInverters"));
             return mNumInv;
@@ -105,7 +177,43 @@ class HmSystem {
         }
 
     private:
-        INVERTERTYPE mInverter[MAX_INVERTER];
+        void setupRxRadios(void) {
+            #if (NUM_RX_RADIOS > 0)
+            // the RX radios are parked on the channels in reverse order of
+            // the channel list, the main radio starts listening on the first
+            const uint8_t ce[] = RX_RADIO_CE_PINS;
+            const uint8_t cs[] = RX_RADIO_CS_PINS;
+            for(uint8_t i = 0; i < NUM_RX_RADIOS; i++)
+                RxRadio[i].setup(&BufCtrl, &Dedup, Radio.getDtuRadioId(), Radio.getRfChannel(RF_CHANNELS - 1 - i), ce[i], cs[i]);
+            #endif
+        }
+
+        // open addressing on the lower 4 bytes of the serial, which are the
+        // address of the inverter in each frame
+        inline uint8_t getHash(uint32_t addr) {
+            return (uint8_t)((uint32_t)(addr * 2654435761U) >> 24) & (INV_IDX_SIZE - 1);
+        }
+
+        void addToIndex(INVERTERTYPE *p) {
+            if(0ULL == p->serial.u64)
+                return;
+            uint8_t h = getHash((uint32_t)p->serial.u64);
+            for(uint8_t i = 0; i < INV_IDX_SIZE; i++, h = (h + 1) & (INV_IDX_SIZE - 1)) {
+                if(0 == mIdx[h]) {
+                    mIdx[h] = p->id + 1;
+                    return;
+                }
+                if(mInverter[mIdx[h] - 1] == p)
+                    return;
+            }
+        }
+
+        // twice the number of slots, rounded up to a power of two
+        static const uint8_t INV_IDX_SIZE = (MAX_INVERTER <= 4) ? 8 : ((MAX_INVERTER <= 8) ? 16 : ((MAX_INVERTER <= 16) ? 32 : ((MAX_INVERTER <= 32) ? 64 : 128)));
+        static_assert(MAX_INVERTER <= 64, "inverter index holds 64 inverters");
+
+        INVERTERTYPE *mInverter[MAX_INVERTER]; // allocated for configured slots only
+        uint8_t mIdx[INV_IDX_SIZE];            // position + 1 of the inverter, 0 = empty
         uint8_t mNumInv;
 };
 
@@ -0,0 +1,149 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+// Compares the payload decoders generated from the assignment tables
+// (recDecoder, Inverter::addValues) with the interpreter of the tables
+// (Inverter::addValue per field): both have to produce identical records,
+// change masks and inverter states for random payloads. Their time per
+// payload is printed, see Makefile. Exits with 1 on a difference.
+
+#include <chrono>
+#include <unistd.h>
+
+#include "defines.h"
+#include "hmInverter.h"
+
+#define BENCH_PAYLOAD_LEN   256     // covers every offset of the tables (uint8_t)
+#define BENCH_PAYLOADS      16      // different payloads, decoded in turn
+#define BENCH_CHECK_RUNS    10000   // random payloads compared per record
+#define BENCH_TIME_RUNS     200000  // decoded payloads per measurement
+
+typedef struct {
+    const char *name;
+    uint8_t type;
+    uint8_t cmd;
+} benchRec_t;
+
+const benchRec_t benchRecs[] = {
+    {"1ch live",  INV_TYPE_1CH, RealTimeRunData_Debug},
+    {"2ch live",  INV_TYPE_2CH, RealTimeRunData_Debug},
+    {"4ch live",  INV_TYPE_4CH, RealTimeRunData_Debug},
+    {"info",      INV_TYPE_4CH, InverterDevInform_All},
+    {"config",    INV_TYPE_4CH, SystemConfigPara},
+    {"alarm",     INV_TYPE_4CH, AlarmData}
+};
+
+static uint8_t payloads[BENCH_PAYLOADS][BENCH_PAYLOAD_LEN];
+
+//-----------------------------------------------------------------------------
+static void initInverter(Inverter<> *iv, uint8_t type) {
+    iv->type = type;
+    iv->serial.u64 = 0x116100000001ULL;
+    iv->init();
+}
+
+//-----------------------------------------------------------------------------
+static void interpret(Inverter<> *iv, uint8_t buf[], record_t<> *rec) {
+    for(uint8_t i = 0; i < rec->length; i++)
+        iv->addValue(i, buf, rec);
+}
+
+//-----------------------------------------------------------------------------
+// random values, small ones (and repeated payloads) to get unchanged fields
+static void fillPayload(uint8_t buf[]) {
+    for(uint16_t i = 0; i < BENCH_PAYLOAD_LEN; i++)
+        buf[i] = (0 == (rand() % 4)) ? 0 : (rand() & 0xff);
+}
+
+//-----------------------------------------------------------------------------
+static bool compare(const benchRec_t *b) {
+    Inverter<> ivInt, ivGen;
+    initInverter(&ivInt, b->type);
+    initInverter(&ivGen, b->type);
+    record_t<> *recInt = ivInt.getRecordStruct(b->cmd);
+    record_t<> *recGen = ivGen.getRecordStruct(b->cmd);
+    uint8_t buf[BENCH_PAYLOAD_LEN];
+
+    for(uint32_t run = 0; run < BENCH_CHECK_RUNS; run++) {
+        if(0 != (run % 3)) // keep the payload every third run
+            fillPayload(buf);
+        recInt->dirty = 0;
+        recGen->dirty = 0;
+        interpret(&ivInt, buf, recInt);
+        ivGen.addValues(buf, recGen);
+
+        if(recInt->dirty != recGen->dirty) {
+            printf("%s: payload %u: changed 0x%llx (interpreter) != 0x%llx (generated)\n", b->name, run,
+                (unsigned long long)recInt->dirty, (unsigned long long)recGen->dirty);
+            return false;
+        }
+        for(uint8_t i = 0; i < recInt->length; i++) {
+            if(0 != memcmp(&recInt->record[i], &recGen->record[i], sizeof(recVal_t))) {
+                printf("%s: payload %u: %s (pos %d) %f != %f\n", b->name, run, ivInt.getFieldName(i, recInt), i,
+                    (double)recInt->record[i], (double)recGen->record[i]);
+                return false;
+            }
+        }
+        if((ivInt.alarmMesIndex != ivGen.alarmMesIndex) || (ivInt.fwVersion != ivGen.fwVersion)
+            || (ivInt.actPowerLimit != ivGen.actPowerLimit) || (ivInt.lastAlarmMsg != ivGen.lastAlarmMsg)) {
+            printf("%s: payload %u: inverter state differs\n", b->name, run);
+            return false;
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// [ns] per payload
+static double measure(const benchRec_t *b, bool generated) {
+    Inverter<> iv;
+    initInverter(&iv, b->type);
+    record_t<> *rec = iv.getRecordStruct(b->cmd);
+
+    auto t0 = std::chrono::steady_clock::now();
+    for(uint32_t run = 0; run < BENCH_TIME_RUNS; run++) {
+        uint8_t *buf = payloads[run % BENCH_PAYLOADS];
+        rec->dirty = 0;
+        if(generated)
+            iv.addValues(buf, rec);
+        else
+            interpret(&iv, buf, rec);
+        iv.clearCmdQueue(); // alarm requests of updateState()
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / BENCH_TIME_RUNS;
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+    unsigned int seed = 1;
+    int opt;
+    while(-1 != (opt = getopt(argc, argv, "r:"))) {
+        if('r' == opt)
+            seed = atoi(optarg);
+        else {
+            fprintf(stderr, "usage: %s [-r seed]\n", argv[0]);
+            return 1;
+        }
+    }
+    srand(seed);
+    for(uint8_t i = 0; i < BENCH_PAYLOADS; i++)
+        fillPayload(payloads[i]);
+
+    bool ok = true;
+    printf("%s records, %d random payloads compared per record\n\n", std::is_integral<recVal_t>::value ? "fixed point" : "float", BENCH_CHECK_RUNS);
+    printf(" record    fields  identical  interpreter[ns]  generated[ns]\n");
+    for(uint8_t i = 0; i < (sizeof(benchRecs) / sizeof(benchRec_t)); i++) {
+        const benchRec_t *b = &benchRecs[i];
+        Inverter<> iv;
+        initInverter(&iv, b->type);
+        bool same = compare(b);
+        ok &= same;
+        printf(" %-8s  %6d  %9s  %15.1f  %13.1f\n", b->name, iv.getRecordStruct(b->cmd)->length,
+            same ? "yes" : "NO", measure(b, false), measure(b, true));
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+// Runs the firmware (app, HmSystem, HmSimRadio) on the host for a simulated
+// time and prints throughput and latency, see Makefile.
+
+#include <chrono>
+#include <unistd.h>
+
+#include "app.h"
+
+// serial numbers of the simulated inverters (4ch, 2ch, 1ch, ...)
+const uint64_t simSerials[] = {0x116100000001ULL, 0x114100000002ULL, 0x112100000003ULL, 0x116100000004ULL};
+
+//-----------------------------------------------------------------------------
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s [-t secs] [-n inverters] [-l loss%%] [-d dup%%] [-b biterr%%] [-s step_us] [-r seed] [-v]\n", name);
+    exit(1);
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+    uint32_t secs = 3600;
+    uint8_t numInv = MAX_NUM_INVERTERS;
+    uint8_t lossPct = SIM_DEF_LOSS_PCT, dupPct = SIM_DEF_DUP_PCT, bitErrPct = SIM_DEF_BIT_ERR_PCT;
+    uint32_t step = 100; // [us] simulated time per loop
+    unsigned int seed = 1;
+
+    int opt;
+    while(-1 != (opt = getopt(argc, argv, "t:n:l:d:b:s:r:v"))) {
+        switch(opt) {
+            case 't': secs      = atoi(optarg); break;
+            case 'n': numInv    = atoi(optarg); break;
+            case 'l': lossPct   = atoi(optarg); break;
+            case 'd': dupPct    = atoi(optarg); break;
+            case 'b': bitErrPct = atoi(optarg); break;
+            case 's': step      = atoi(optarg); break;
+            case 'r': seed      = atoi(optarg); break;
+            case 'v': Serial.enable(true); break;
+            default:  usage(argv[0]);
+        }
+    }
+    if((0 == numInv) || (numInv > MAX_NUM_INVERTERS) || (numInv > (sizeof(simSerials) / sizeof(uint64_t))) || (0 == step))
+        usage(argv[0]);
+    srand(seed);
+
+    // first boot: the inverters are configured like on the setup page
+    app *cfg = new app();
+    cfg->setup(WIFI_TRY_CONNECT_TIME);
+    for(uint8_t i = 0; i < numInv; i++) {
+        Inverter<> *iv = cfg->mSys->getSlot(i);
+        iv->serial.u64 = simSerials[i];
+        snprintf(iv->name, MAX_NAME_LENGTH, "sim%d", i);
+        for(uint8_t j = 0; j < 4; j++)
+            iv->chMaxPwr[j] = 400;
+    }
+    cfg->saveValues();
+
+    // second boot: the inverters are read from the EEPROM
+    app *a = new app();
+    a->setup(WIFI_TRY_CONNECT_TIME);
+    for(uint8_t i = 0; i < RF_CHANNELS; i++)
+        a->mSys->Radio.setChannelModel(i, lossPct, dupPct, bitErrPct);
+
+    uint32_t start = millis();
+    uint64_t loops = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    while((millis() - start) < (secs * 1000)) {
+        a->loop();
+        hostAdvance(step);
+        loops++;
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    statistics_t *stat = a->getStatistics();
+    HmSystemType::RadioType *radio = &a->mSys->Radio;
+    uint32_t payloads = stat->rxSuccess + stat->rxFail + stat->rxFailNoAnser;
+
+    printf("simulated %u s, %d inverters, loss/dup/biterr %d/%d/%d %%, %u us per loop\n", secs, numInv, lossPct, dupPct, bitErrPct, step);
+    printf("host:     %llu loops in %.3f s, %.0f ns per loop\n", (unsigned long long)loops, wall, (wall * 1e9) / loops);
+    printf("radio:    %u requests, %u frames sent, %u lost, %u duplicated, %u with bit error\n", radio->mSendCnt, radio->mFrmCnt, radio->mLostCnt, radio->mDupCnt, radio->mBitErrCnt);
+    printf("payloads: %u ok, %u failed, %u without answer (%.1f %% ok), %u frames received\n", stat->rxSuccess, stat->rxFail, stat->rxFailNoAnser,
+        (0 == payloads) ? 0.0 : (100.0 * stat->rxSuccess / payloads), stat->frmCnt);
+    printf("\n id  frames  crc_fail  dup  missing  retransmits  rtt_avg[ms]\n");
+    for(uint8_t i = 0; i < numInv; i++) {
+        ivLinkStat_t *link = a->getIvLinkStat(i);
+        printf("%3d  %6u  %8u  %3u  %7u  %11u  %11u\n", i, link->frmCnt, link->crcFail, link->dupCnt, link->missing, link->retransmits, link->rttAvg);
+    }
+    printf("\n ch  frames  crc_fail  dup\n");
+    for(uint8_t i = 0; i < RF_CHANNELS; i++) {
+        chLinkStat_t *link = a->getChLinkStat(i);
+        printf("%3d  %6u  %8u  %3u\n", radio->getRfChannel(i), link->frmCnt, link->crcFail, link->dupCnt);
+    }
+
+    return 0;
+}
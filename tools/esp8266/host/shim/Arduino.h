@@ -0,0 +1,207 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_ARDUINO_H__
+#define __HOST_ARDUINO_H__
+
+// Minimal Arduino core for the host build (see ../Makefile). The time is
+// simulated: millis() / micros() only move if the host main calls
+// hostAdvance() or the firmware calls delay().
+
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdarg>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <functional>
+#include <sys/types.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HEX         16
+#define DEC         10
+#define INPUT       0
+#define OUTPUT      1
+#define INPUT_PULLUP 2
+#define FALLING     2
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+#define PROGMEM
+#define F(sl)       (sl)
+#define B11100011   0xe3
+
+#define radians(deg) ((deg) * M_PI / 180.0)
+#define degrees(rad) ((rad) * 180.0 / M_PI)
+
+class __FlashStringHelper;
+
+
+//-----------------------------------------------------------------------------
+class String : public std::string {
+    public:
+        String() {}
+        String(const char *s) : std::string((NULL == s) ? "" : s) {}
+        String(const std::string &s) : std::string(s) {}
+        String(char c) : std::string(1, c) {}
+        String(unsigned char v, unsigned char base = DEC)      : std::string(num((unsigned long long)v, base)) {}
+        String(int v, unsigned char base = DEC)                : std::string(sig((long long)v, base)) {}
+        String(unsigned int v, unsigned char base = DEC)       : std::string(num((unsigned long long)v, base)) {}
+        String(long v, unsigned char base = DEC)               : std::string(sig((long long)v, base)) {}
+        String(unsigned long v, unsigned char base = DEC)      : std::string(num((unsigned long long)v, base)) {}
+        String(long long v, unsigned char base = DEC)          : std::string(sig(v, base)) {}
+        String(unsigned long long v, unsigned char base = DEC) : std::string(num(v, base)) {}
+        String(float v, unsigned char digits = 2)  : std::string(flt(v, digits)) {}
+        String(double v, unsigned char digits = 2) : std::string(flt(v, digits)) {}
+
+        // like the Arduino String: usable as condition, true if valid
+        typedef void (String::*StringIfHelperType)() const;
+        void StringIfHelper() const {}
+        operator StringIfHelperType() const { return &String::StringIfHelper; }
+
+        String substring(unsigned int from) const {
+            return (from >= length()) ? String() : String(substr(from));
+        }
+        String substring(unsigned int from, unsigned int to) const {
+            return (from >= length()) ? String() : String(substr(from, to - from));
+        }
+        bool endsWith(const String &s) const {
+            return (length() >= s.length()) && (0 == compare(length() - s.length(), s.length(), s));
+        }
+        void replace(const String &find, const String &repl) {
+            if(find.empty())
+                return;
+            for(size_t pos = 0; std::string::npos != (pos = std::string::find(find, pos)); pos += repl.length())
+                std::string::replace(pos, find.length(), repl);
+        }
+        void trim(void) {
+            erase(0, find_first_not_of(" \t\r\n"));
+            erase(find_last_not_of(" \t\r\n") + 1);
+        }
+        void toCharArray(char *buf, unsigned int size) const {
+            if(0 == size)
+                return;
+            snprintf(buf, size, "%s", c_str());
+        }
+        long toInt(void) const { return atol(c_str()); }
+        float toFloat(void) const { return atof(c_str()); }
+
+    private:
+        static std::string num(unsigned long long v, unsigned char base) {
+            char buf[68];
+            snprintf(buf, sizeof(buf), (HEX == base) ? "%llx" : "%llu", v);
+            return buf;
+        }
+        static std::string sig(long long v, unsigned char base) {
+            return ((v < 0) && (DEC == base)) ? ("-" + num(-v, base)) : num(v, base);
+        }
+        static std::string flt(double v, unsigned char digits) {
+            char buf[40];
+            snprintf(buf, sizeof(buf), "%.*f", digits, v);
+            return buf;
+        }
+};
+
+inline String operator+(const String &a, const String &b) { return String(static_cast<const std::string &>(a) + static_cast<const std::string &>(b)); }
+inline String operator+(const char *a, const String &b)   { return String(a) + b; }
+inline String operator+(const String &a, const char *b)   { return a + String(b); }
+inline String operator+(const String &a, char b)          { return a + String(b); }
+
+
+//-----------------------------------------------------------------------------
+// prints to stdout if enabled (verbose run of the host main)
+class HardwareSerial {
+    public:
+        HardwareSerial() : mEnabled(false) {}
+        void begin(unsigned long baud) {}
+        void enable(bool en) { mEnabled = en; }
+        void print(const String &s)               { out(s); }
+        void print(const char *s)                 { out(s); }
+        void print(char c)                        { out(String(c)); }
+        void print(int v, int base = DEC)         { out(String(v, base)); }
+        void print(unsigned int v, int base = DEC){ out(String(v, base)); }
+        void print(long v, int base = DEC)        { out(String(v, base)); }
+        void print(unsigned long v, int base = DEC) { out(String(v, base)); }
+        void print(unsigned char v, int base = DEC) { out(String(v, base)); }
+        void print(float v, int digits = 2)       { out(String(v, digits)); }
+        template<class T> void println(T v)       { print(v); out("\r\n"); }
+        void println(void)                        { out("\r\n"); }
+        void printf(const char *fmt, ...) {
+            if(!mEnabled)
+                return;
+            va_list args;
+            va_start(args, fmt);
+            vprintf(fmt, args);
+            va_end(args);
+        }
+        void flush(void)                          { fflush(stdout); }
+
+    private:
+        void out(const String &s) {
+            if(mEnabled)
+                fputs(s.c_str(), stdout);
+        }
+        bool mEnabled;
+};
+extern HardwareSerial Serial;
+
+
+//-----------------------------------------------------------------------------
+class EspClass {
+    public:
+        uint32_t getChipId(void) { return 0x00a4cafe; }
+        uint32_t getFreeHeap(void) { return 40000; }
+        uint32_t getMaxFreeBlockSize(void) { return 20000; }
+        uint8_t getHeapFragmentation(void) { return 0; }
+        void getHeapStats(uint32_t *free, uint16_t *max, uint8_t *frag) {
+            *free = getFreeHeap();
+            *max  = getMaxFreeBlockSize();
+            *frag = getHeapFragmentation();
+        }
+        uint32_t getFlashChipSize(void) { return 4 * 1024 * 1024; }
+        uint32_t getSketchSize(void) { return 0; }
+        uint32_t getFreeSketchSpace(void) { return 0; }
+        const char *getSdkVersion(void) { return "host"; }
+        String getCoreVersion(void) { return "host"; }
+        uint8_t getCpuFreqMHz(void) { return 80; }
+        void restart(void);
+};
+extern EspClass ESP;
+
+
+//-----------------------------------------------------------------------------
+// firmware updates aren't possible on the host
+class UpdaterClass {
+    public:
+        bool begin(size_t size) { return false; }
+        size_t write(uint8_t *data, size_t len) { return 0; }
+        bool end(bool evenIfRemaining = false) { return false; }
+        void runAsync(bool async) {}
+        bool hasError(void) { return true; }
+        void printError(HardwareSerial &out) { out.println("update not supported"); }
+};
+extern UpdaterClass Update;
+
+
+//-----------------------------------------------------------------------------
+uint32_t millis(void);
+uint32_t micros(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+inline void yield(void) {}
+inline void noInterrupts(void) {}
+inline void interrupts(void) {}
+inline void pinMode(uint8_t pin, uint8_t mode) {}
+inline int digitalPinToInterrupt(int pin) { return pin; }
+inline void attachInterrupt(int intr, void (*cb)(void), int mode) {}
+long random(long max);
+long random(long min, long max);
+
+// simulated time, advanced by the host main
+void hostAdvance(uint32_t us);
+
+#endif /*__HOST_ARDUINO_H__*/
@@ -0,0 +1,82 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_ARDUINO_JSON_H__
+#define __HOST_ARDUINO_JSON_H__
+
+#include "Arduino.h"
+
+// Accepts the ArduinoJson calls of the firmware and drops the values, the
+// web API and the MQTT documents aren't looked at on the host.
+
+class JsonArray;
+class JsonObject;
+
+class JsonVariant {
+    public:
+        template<class T> JsonVariant &operator=(const T &val) { return *this; }
+        template<class T> JsonVariant operator[](const T &key) const { return JsonVariant(); }
+        template<class T> bool operator==(const T &val) const { return false; }
+        template<class T> bool operator!=(const T &val) const { return true; }
+        template<class T> operator T() const { return T(); }
+        template<class T> T as(void) const { return T(); }
+        template<class T> bool containsKey(const T &key) const { return false; }
+        template<class T> bool add(const T &val) { return true; }
+        bool isNull(void) const { return true; }
+        size_t size(void) const { return 0; }
+        JsonArray createNestedArray(void);
+        JsonObject createNestedObject(void);
+        template<class T> JsonArray createNestedArray(const T &key);
+        template<class T> JsonObject createNestedObject(const T &key);
+};
+template<class T> bool operator==(const T &val, const JsonVariant &v) { return false; }
+
+class JsonObject : public JsonVariant {
+    public:
+        using JsonVariant::operator=;
+};
+
+class JsonArray : public JsonVariant {
+    public:
+        using JsonVariant::operator=;
+        JsonVariant *begin(void) const { return NULL; }
+        JsonVariant *end(void) const { return NULL; }
+};
+
+inline JsonArray JsonVariant::createNestedArray(void) { return JsonArray(); }
+inline JsonObject JsonVariant::createNestedObject(void) { return JsonObject(); }
+template<class T> JsonArray JsonVariant::createNestedArray(const T &key) { return JsonArray(); }
+template<class T> JsonObject JsonVariant::createNestedObject(const T &key) { return JsonObject(); }
+
+class DynamicJsonDocument : public JsonVariant {
+    public:
+        DynamicJsonDocument(size_t capa) {}
+        using JsonVariant::operator=;
+        void clear(void) {}
+        size_t memoryUsage(void) const { return 0; }
+};
+
+class DeserializationError {
+    public:
+        enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory, TooDeep };
+        DeserializationError() : mCode(Ok) {}
+        Code code(void) const { return mCode; }
+        const char *c_str(void) const { return "Ok"; }
+        explicit operator bool(void) const { return (Ok != mCode); }
+    private:
+        Code mCode;
+};
+
+template<class D, class S> DeserializationError deserializeJson(D &doc, const S &input) { return DeserializationError(); }
+template<class T> size_t serializeJson(const T &doc, char *buf, size_t size) { if(0 != size) buf[0] = '\0'; return 0; }
+template<class T, size_t N> size_t serializeJson(const T &doc, char (&buf)[N]) { buf[0] = '\0'; return 0; }
+template<class T> size_t serializeJson(const T &doc, String &out) { out = ""; return 0; }
+template<class T> size_t measureJson(const T &doc) { return 0; }
+template<class T> struct SerializedValue {
+    T str;
+};
+template<class T> SerializedValue<T> serialized(const T &raw) { return SerializedValue<T>{raw}; }
+
+#endif /*__HOST_ARDUINO_JSON_H__*/
@@ -0,0 +1,21 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_ASYNC_JSON_H__
+#define __HOST_ASYNC_JSON_H__
+
+#include "ArduinoJson.h"
+#include "ESPAsyncWebServer.h"
+
+class AsyncJsonResponse : public AsyncWebServerResponse {
+    public:
+        AsyncJsonResponse(bool isArray = false, size_t maxJsonBufferSize = 1024) {}
+        JsonVariant &getRoot(void) { return mRoot; }
+        size_t setLength(void) { return 0; }
+    private:
+        JsonVariant mRoot;
+};
+
+#endif /*__HOST_ASYNC_JSON_H__*/
@@ -0,0 +1,17 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_DNS_SERVER_H__
+#define __HOST_DNS_SERVER_H__
+
+#include "ESP8266WiFi.h"
+
+class DNSServer {
+    public:
+        bool start(uint16_t port, const String &domain, IPAddress ip) { return true; }
+        void processNextRequest(void) {}
+};
+
+#endif /*__HOST_DNS_SERVER_H__*/
@@ -0,0 +1,31 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_EEPROM_H__
+#define __HOST_EEPROM_H__
+
+#include "Arduino.h"
+
+#define HOST_EEPROM_SIZE    4096
+
+// kept in RAM, survives a new app instance (reboot of the host main)
+class EEPROMClass {
+    public:
+        EEPROMClass() { memset(mData, 0xff, HOST_EEPROM_SIZE); }
+        bool begin(size_t size) { return (size <= HOST_EEPROM_SIZE); }
+        void end(void) {}
+        uint8_t read(int addr) { return (addr < HOST_EEPROM_SIZE) ? mData[addr] : 0xff; }
+        void write(int addr, uint8_t val) {
+            if(addr < HOST_EEPROM_SIZE)
+                mData[addr] = val;
+        }
+        bool commit(void) { return true; }
+
+    private:
+        uint8_t mData[HOST_EEPROM_SIZE];
+};
+extern EEPROMClass EEPROM;
+
+#endif /*__HOST_EEPROM_H__*/
@@ -0,0 +1,71 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_ESP8266_WIFI_H__
+#define __HOST_ESP8266_WIFI_H__
+
+#include "Arduino.h"
+
+#define WL_IDLE_STATUS  0
+#define WL_CONNECTED    3
+#define WIFI_STA        1
+#define WIFI_AP         2
+
+class IPAddress {
+    public:
+        IPAddress() : mAddr(0) {}
+        IPAddress(uint32_t addr) : mAddr(addr) {}
+        IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : mAddr(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+        operator uint32_t() const { return mAddr; }
+        bool fromString(const char *str) {
+            unsigned a, b, c, d;
+            if(4 != sscanf(str, "%u.%u.%u.%u", &a, &b, &c, &d))
+                return false;
+            mAddr = a | (b << 8) | (c << 16) | (d << 24);
+            return true;
+        }
+        String toString(void) const {
+            char buf[16];
+            snprintf(buf, 16, "%u.%u.%u.%u", mAddr & 0xff, (mAddr >> 8) & 0xff, (mAddr >> 16) & 0xff, mAddr >> 24);
+            return String(buf);
+        }
+
+    private:
+        uint32_t mAddr;
+};
+
+class WiFiClient {
+    public:
+        void setTimeout(unsigned long timeout) {}
+        int connect(IPAddress ip, uint16_t port) { return 0; }
+        int connect(const char *host, uint16_t port) { return 0; }
+        void stop(void) {}
+};
+
+// always connected to the station network
+class ESP8266WiFiClass {
+    public:
+        void mode(uint8_t m) {}
+        void begin(const char *ssid, const char *pwd) {}
+        void hostname(const char *name) {}
+        void disconnect(void) {}
+        uint8_t status(void) { return WL_CONNECTED; }
+        IPAddress localIP(void) { return IPAddress(127, 0, 0, 1); }
+        String macAddress(void) { return "02:00:00:00:00:01"; }
+        String SSID(void) { return "host"; }
+        String SSID(uint8_t i) { return ""; }
+        int32_t RSSI(void) { return -50; }
+        int32_t RSSI(uint8_t i) { return 0; }
+        bool softAPConfig(IPAddress ip, IPAddress gw, IPAddress mask) { return true; }
+        bool softAP(const char *ssid, const char *pwd) { return true; }
+        uint8_t softAPgetStationNum(void) { return 0; }
+        int hostByName(const char *host, IPAddress &ip) { ip = IPAddress(127, 0, 0, 1); return 1; }
+        int8_t scanComplete(void) { return 0; }
+        int8_t scanNetworks(bool async) { return 0; }
+        void scanDelete(void) {}
+};
+extern ESP8266WiFiClass WiFi;
+
+#endif /*__HOST_ESP8266_WIFI_H__*/
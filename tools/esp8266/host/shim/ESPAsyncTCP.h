@@ -0,0 +1,11 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_ESP_ASYNC_TCP_H__
+#define __HOST_ESP_ASYNC_TCP_H__
+
+// nothing needed, the web server of the host build doesn't serve anything
+
+#endif /*__HOST_ESP_ASYNC_TCP_H__*/
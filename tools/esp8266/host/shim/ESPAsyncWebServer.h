@@ -0,0 +1,85 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_ESP_ASYNC_WEB_SERVER_H__
+#define __HOST_ESP_ASYNC_WEB_SERVER_H__
+
+#include "Arduino.h"
+
+// the handlers are registered only, no request reaches them on the host
+
+enum { HTTP_GET = 0x01, HTTP_POST = 0x02, HTTP_ANY = 0xff };
+
+class AsyncWebServerResponse {
+    public:
+        virtual ~AsyncWebServerResponse() {}
+        void addHeader(const String &name, const String &value) {}
+        void setLength(void) {}
+};
+
+class AsyncWebParameter {
+    public:
+        const String &value(void) const { return mValue; }
+    private:
+        String mValue;
+};
+
+class AsyncWebServerRequest {
+    public:
+        String url(void) { return ""; }
+        String host(void) { return ""; }
+        int method(void) { return HTTP_GET; }
+        void send(AsyncWebServerResponse *response) { delete response; }
+        void send(int code, const String &type = String(), const String &content = String()) {}
+        void redirect(const String &url) {}
+        bool hasParam(const String &name, bool post = false) { return false; }
+        AsyncWebParameter *getParam(const String &name, bool post = false) { return NULL; }
+        bool hasArg(const char *name) { return false; }
+        const String &arg(const String &name) { return mEmpty; }
+        const String &arg(size_t i) { return mEmpty; }
+        const String &argName(size_t i) { return mEmpty; }
+        size_t args(void) { return 0; }
+        AsyncWebServerResponse *beginResponse(int code, const String &type = String(), const String &content = String()) { return new AsyncWebServerResponse(); }
+        AsyncWebServerResponse *beginResponse_P(int code, const String &type, const uint8_t *content, size_t len) { return new AsyncWebServerResponse(); }
+        void *_tempObject;
+    private:
+        String mEmpty;
+};
+
+typedef std::function<void(AsyncWebServerRequest *request)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest *request, const String &filename, size_t index, uint8_t *data, size_t len, bool final)> ArUploadHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)> ArBodyHandlerFunction;
+
+class AsyncCallbackWebHandler {
+    public:
+        AsyncCallbackWebHandler &onBody(ArBodyHandlerFunction fn) { return *this; }
+};
+
+class AsyncEventSourceClient {
+    public:
+        uint32_t lastId(void) const { return 0; }
+        void send(const char *msg, const char *event = NULL, uint32_t id = 0, uint32_t reconnect = 0) {}
+};
+
+class AsyncEventSource {
+    public:
+        AsyncEventSource(const String &url) {}
+        void onConnect(std::function<void(AsyncEventSourceClient *client)> cb) {}
+        void send(const char *msg, const char *event = NULL, uint32_t id = 0, uint32_t reconnect = 0) {}
+};
+
+class AsyncWebServer {
+    public:
+        AsyncWebServer(uint16_t port) {}
+        void begin(void) {}
+        AsyncCallbackWebHandler &on(const char *uri, int method, ArRequestHandlerFunction fn) { return mHandler; }
+        AsyncCallbackWebHandler &on(const char *uri, int method, ArRequestHandlerFunction fn, ArUploadHandlerFunction upload) { return mHandler; }
+        void onNotFound(ArRequestHandlerFunction fn) {}
+        void addHandler(AsyncEventSource *handler) {}
+    private:
+        AsyncCallbackWebHandler mHandler;
+};
+
+#endif /*__HOST_ESP_ASYNC_WEB_SERVER_H__*/
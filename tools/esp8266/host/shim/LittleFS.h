@@ -0,0 +1,41 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_LITTLE_FS_H__
+#define __HOST_LITTLE_FS_H__
+
+#include "Arduino.h"
+
+// no file system on the host, the MQTT outbox isn't used without a broker
+class File {
+    public:
+        explicit operator bool(void) const { return false; }
+        size_t read(uint8_t *buf, size_t size) { return 0; }
+        size_t write(const uint8_t *buf, size_t size) { return 0; }
+        bool seek(uint32_t pos) { return false; }
+        size_t size(void) const { return 0; }
+        void close(void) {}
+};
+
+struct FSInfo {
+    size_t totalBytes;
+    size_t usedBytes;
+    size_t blockSize;
+    size_t pageSize;
+    size_t maxOpenFiles;
+    size_t maxPathLength;
+};
+
+class FS {
+    public:
+        bool begin(void) { return false; }
+        bool info(FSInfo &info) { return false; }
+        File open(const char *path, const char *mode) { return File(); }
+        bool exists(const char *path) { return false; }
+        bool remove(const char *path) { return false; }
+};
+extern FS LittleFS;
+
+#endif /*__HOST_LITTLE_FS_H__*/
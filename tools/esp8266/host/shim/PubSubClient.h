@@ -0,0 +1,37 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_PUB_SUB_CLIENT_H__
+#define __HOST_PUB_SUB_CLIENT_H__
+
+#include "ESP8266WiFi.h"
+
+// there is no broker on the host, the client never connects
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char *, uint8_t *, unsigned int)> callback
+
+class PubSubClient {
+    public:
+        PubSubClient(WiFiClient &client) {}
+        PubSubClient &setServer(IPAddress ip, uint16_t port) { return *this; }
+        PubSubClient &setServer(const char *domain, uint16_t port) { return *this; }
+        PubSubClient &setCallback(MQTT_CALLBACK_SIGNATURE) { return *this; }
+        PubSubClient &setKeepAlive(uint16_t keepAlive) { return *this; }
+        PubSubClient &setSocketTimeout(uint16_t timeout) { return *this; }
+        bool setBufferSize(uint16_t size) { return true; }
+        bool connect(const char *id, const char *user, const char *pass, const char *willTopic, uint8_t willQos, bool willRetain, const char *willMessage, bool cleanSession = true) { return false; }
+        bool connect(const char *id, const char *willTopic, uint8_t willQos, bool willRetain, const char *willMessage) { return false; }
+        void disconnect(void) {}
+        bool connected(void) { return false; }
+        int state(void) { return -2; }
+        bool publish(const char *topic, const char *payload, bool retained = false) { return false; }
+        bool publish(const char *topic, const uint8_t *payload, unsigned int len, bool retained) { return false; }
+        bool beginPublish(const char *topic, unsigned int len, bool retained) { return false; }
+        size_t write(const uint8_t *buf, size_t size) { return 0; }
+        int endPublish(void) { return 0; }
+        bool subscribe(const char *topic) { return false; }
+        bool loop(void) { return false; }
+};
+
+#endif /*__HOST_PUB_SUB_CLIENT_H__*/
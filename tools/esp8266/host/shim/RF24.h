@@ -0,0 +1,11 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_RF24_H__
+#define __HOST_RF24_H__
+
+// the host build uses the simulated radio (SIM_RADIO), RF24 is not used
+
+#endif /*__HOST_RF24_H__*/
@@ -0,0 +1,9 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_RF24_CONFIG_H__
+#define __HOST_RF24_CONFIG_H__
+
+#endif /*__HOST_RF24_CONFIG_H__*/
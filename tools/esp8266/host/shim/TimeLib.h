@@ -0,0 +1,18 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_TIME_LIB_H__
+#define __HOST_TIME_LIB_H__
+
+#include <ctime>
+
+int year(time_t t);
+int month(time_t t);
+int day(time_t t);
+int hour(time_t t);
+int minute(time_t t);
+int second(time_t t);
+
+#endif /*__HOST_TIME_LIB_H__*/
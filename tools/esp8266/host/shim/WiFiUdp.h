@@ -0,0 +1,26 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_WIFI_UDP_H__
+#define __HOST_WIFI_UDP_H__
+
+#include "ESP8266WiFi.h"
+
+// answers every NTP request, see hostNtpTime() in hostShim.cpp
+class WiFiUDP {
+    public:
+        WiFiUDP() : mPending(false) {}
+        uint8_t begin(uint16_t port) { return 1; }
+        int beginPacket(IPAddress ip, uint16_t port) { return 1; }
+        size_t write(const uint8_t *buf, size_t len) { return len; }
+        int endPacket(void) { mPending = true; return 1; }
+        int parsePacket(void) { return mPending ? 48 : 0; }
+        int read(uint8_t *buf, size_t len);
+
+    private:
+        bool mPending;
+};
+
+#endif /*__HOST_WIFI_UDP_H__*/
@@ -0,0 +1,96 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "ESP8266WiFi.h"
+#include "WiFiUdp.h"
+#include "TimeLib.h"
+#include "LittleFS.h"
+
+// UTC time of the simulated start, answered by the NTP server
+#define HOST_NTP_START      1656662400UL // 2022-07-01 08:00:00
+
+HardwareSerial Serial;
+EspClass ESP;
+UpdaterClass Update;
+EEPROMClass EEPROM;
+ESP8266WiFiClass WiFi;
+FS LittleFS;
+
+static uint64_t hostMicros = 0;
+
+//-----------------------------------------------------------------------------
+uint32_t millis(void) {
+    return (uint32_t)(hostMicros / 1000);
+}
+
+//-----------------------------------------------------------------------------
+uint32_t micros(void) {
+    return (uint32_t)hostMicros;
+}
+
+//-----------------------------------------------------------------------------
+void delay(uint32_t ms) {
+    hostMicros += (uint64_t)ms * 1000;
+}
+
+//-----------------------------------------------------------------------------
+void delayMicroseconds(uint32_t us) {
+    hostMicros += us;
+}
+
+//-----------------------------------------------------------------------------
+void hostAdvance(uint32_t us) {
+    hostMicros += us;
+}
+
+//-----------------------------------------------------------------------------
+long random(long max) {
+    return (max <= 0) ? 0 : (rand() % max);
+}
+
+//-----------------------------------------------------------------------------
+long random(long min, long max) {
+    return (max <= min) ? min : (min + random(max - min));
+}
+
+//-----------------------------------------------------------------------------
+void EspClass::restart(void) {
+    fflush(stdout);
+    fprintf(stderr, "restart requested, stopped\n");
+    exit(0);
+}
+
+//-----------------------------------------------------------------------------
+int WiFiUDP::read(uint8_t *buf, size_t len) {
+    if(!mPending)
+        return 0;
+    mPending = false;
+
+    uint32_t secs = HOST_NTP_START + 2208988800UL + (millis() / 1000); // since 1900
+    memset(buf, 0, len);
+    if(len >= 44) {
+        buf[40] = (secs >> 24) & 0xff;
+        buf[41] = (secs >> 16) & 0xff;
+        buf[42] = (secs >>  8) & 0xff;
+        buf[43] = (secs      ) & 0xff;
+    }
+    return (int)len;
+}
+
+//-----------------------------------------------------------------------------
+static struct tm getTm(time_t t) {
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    return tm;
+}
+
+int year(time_t t)   { return getTm(t).tm_year + 1900; }
+int month(time_t t)  { return getTm(t).tm_mon + 1; }
+int day(time_t t)    { return getTm(t).tm_mday; }
+int hour(time_t t)   { return getTm(t).tm_hour; }
+int minute(time_t t) { return getTm(t).tm_min; }
+int second(time_t t) { return getTm(t).tm_sec; }
@@ -0,0 +1,27 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_LWIP_DNS_H__
+#define __HOST_LWIP_DNS_H__
+
+#include <cstdint>
+
+typedef int8_t err_t;
+typedef struct { uint32_t addr; } ip4_addr_t;
+typedef struct { ip4_addr_t u_addr; } ip_addr_t;
+typedef void (*dns_found_callback)(const char *name, const ip_addr_t *ipaddr, void *arg);
+
+#define ERR_OK              0
+#define ERR_INPROGRESS      -5
+#define ERR_ARG             -16
+#define ip_2_ip4(ipaddr)    (&((ipaddr)->u_addr))
+#define ip4_addr_get_u32(a) ((a)->addr)
+
+// no broker to resolve on the host
+inline err_t dns_gethostbyname(const char *hostname, ip_addr_t *addr, dns_found_callback found, void *arg) {
+    return ERR_ARG;
+}
+
+#endif /*__HOST_LWIP_DNS_H__*/
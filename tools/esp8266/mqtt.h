@@ -17,117 +17,272 @@
   #define F(sl) (sl)
 #endif
 #include <PubSubClient.h>
+#include <lwip/dns.h>
 #include "defines.h"
 
+// joins the parts of a topic without formatting, mid may be NULL. A topic
+// longer than MQTT_TOPIC_MAX isn't cut but not built (returns false)
+inline bool joinTopic(char buf[], const char *prefix, uint8_t prefixLen, const char *mid, const char *suffix) {
+    uint8_t len = prefixLen;
+    memcpy(buf, prefix, len);
+    const char *parts[] = {mid, suffix};
+    for(uint8_t i = 0; i < 2; i++) {
+        for(const char *p = parts[i]; (NULL != p) && ('\0' != *p); p++) {
+            if(len >= (MQTT_TOPIC_MAX - 1)) {
+                DPRINTLN(DBG_WARN, F("MQTT topic too long: ") + String(suffix));
+                return false;
+            }
+            buf[len++] = *p;
+        }
+    }
+    buf[len] = '\0';
+    return true;
+}
+
+// connection states, see mqtt::loop()
+enum {MQTT_STATE_IDLE = 0, MQTT_STATE_DNS, MQTT_STATE_DNS_WAIT, MQTT_STATE_TCP, MQTT_STATE_CONNECT, MQTT_STATE_SUBSCRIBE, MQTT_STATE_CONNECTED, MQTT_STATE_BACKOFF};
+
 class mqtt {
     public:
         mqtt() {
             mClient     = new PubSubClient(mEspClient);
-            mAddressSet = false;
 
-            mLastReconnect = 0;
+            mState    = MQTT_STATE_IDLE;
+            mStateTs  = 0;
+            mBackoff  = MQTT_RECONNECT_DELAY;
+            mWait     = 0;
+            mDnsState = MQTT_DNS_IDLE;
             mTxCnt = 0;
 
             memset(mDevName, 0, DEVNAME_LEN);
+            mVersion = NULL;
+            mCfg = NULL;
+            mBaseLen = 0;
         }
 
         ~mqtt() { }
 
-        void setup(mqttConfig_t *cfg, const char *devname) {
+        void setup(mqttConfig_t *cfg, const char *devname, const char *version) {
             DPRINTLN(DBG_VERBOSE, F("mqtt.h:setup"));
-            mAddressSet = true;
 
             mCfg = cfg;
             snprintf(mDevName, DEVNAME_LEN,    "%s", devname);
+            mVersion = version;
+            setBaseTopic();
 
-            mClient->setServer(mCfg->broker, mCfg->port);
             mClient->setBufferSize(MQTT_MAX_PACKET_SIZE);
+            mClient->setSocketTimeout(MQTT_CONNACK_TIMEOUT);
+            if(strlen(mCfg->broker) > 0)
+                setState(MQTT_STATE_DNS);
         }
 
         void setCallback(MQTT_CALLBACK_SIGNATURE){
             mClient->setCallback(callback);
         }
 
-        void sendMsg(const char *topic, const char *msg) {
+        // takes over a changed topic of the configuration
+        void setBaseTopic(void) {
+            if(NULL == mCfg)
+                return;
+            mBaseLen = strnlen(mCfg->topic, MQTT_TOPIC_LEN - 1);
+            memcpy(mBase, mCfg->topic, mBaseLen);
+            mBase[mBaseLen++] = '/';
+            mBase[mBaseLen] = '\0';
+        }
+
+        // messages are dropped while the connection is (re)established
+        bool sendMsg(const char *topic, const char *msg) {
             //DPRINTLN(DBG_VERBOSE, F("mqtt.h:sendMsg"));
-            char top[64];
-            snprintf(top, 64, "%s/%s", mCfg->topic, topic);
-            sendMsg2(top, msg, false);
+            if(!isConnected())
+                return false;
+            char top[MQTT_TOPIC_MAX];
+            if(!joinTopic(top, mBase, mBaseLen, NULL, topic))
+                return false;
+            return sendTopic(top, msg);
+        }
+
+        // message on a complete topic, see joinTopic()
+        bool sendTopic(const char *topic, const char *msg) {
+            if(!sendMsg2(topic, msg, false))
+                return false;
             mTxCnt++;
+            return true;
         }
 
-        void sendMsg2(const char *topic, const char *msg, boolean retained) {
-            if(mAddressSet) {
-                if(!mClient->connected())
-                    reconnect();
-                if(mClient->connected())
-                    mClient->publish(topic, msg, retained);
-            }
+        bool sendMsg2(const char *topic, const char *msg, boolean retained) {
+            if(isConnected())
+                return mClient->publish(topic, msg, retained);
+            return false;
         }
 
-        bool isConnected(bool doRecon = false) {
-            //DPRINTLN(DBG_VERBOSE, F("mqtt.h:isConnected"));
-            if(doRecon && !mClient->connected())
-                reconnect();
-            return mClient->connected();
+        bool isConnected(void) {
+            return (MQTT_STATE_CONNECTED == mState) && mClient->connected();
         }
 
+        // advances the connection by one step, none of them waits longer
+        // than MQTT_CONNECT_TIMEOUT (TCP) or MQTT_CONNACK_TIMEOUT (broker)
         void loop() {
-            //DPRINT(F("m"));
-            if(!mClient->connected())
-                reconnect();
-            mClient->loop();
-        }
 
-        uint32_t getTxCnt(void) {
-            return mTxCnt;
-        }
+            switch(mState) {
+                case MQTT_STATE_DNS:
+                    if(mBrokerIp.fromString(mCfg->broker))
+                        setState(MQTT_STATE_TCP);
+                    else
+                        resolve();
+                    break;
 
-    private:
-        void reconnect(void) {
-            DPRINTLN(DBG_DEBUG, F("mqtt.h:reconnect"));
-            DPRINTLN(DBG_DEBUG, F("MQTT mClient->_state ") + String(mClient->state()) );
-
-            #ifdef ESP8266
-                DPRINTLN(DBG_DEBUG, F("WIFI mEspClient.status ") + String(mEspClient.status()) );
-            #endif
-
-            boolean resub = false;
-            if(!mClient->connected() && (millis() - mLastReconnect) > MQTT_RECONNECT_DELAY ) {
-                mLastReconnect = millis();
-                if(strlen(mDevName) > 0) {
-                    // der Server und der Port müssen neu gesetzt werden, 
-                    // da ein MQTT_CONNECTION_LOST -3 die Werte zerstört hat.
-                    mClient->setServer(mCfg->broker, mCfg->port);
-                    mClient->setBufferSize(MQTT_MAX_PACKET_SIZE);
+                case MQTT_STATE_DNS_WAIT:
+                    if(MQTT_DNS_DONE == mDnsState)
+                        setState(MQTT_STATE_TCP);
+                    else if((MQTT_DNS_FAILED == mDnsState) || ((millis() - mStateTs) > MQTT_DNS_TIMEOUT)) {
+                        DPRINTLN(DBG_WARN, F("MQTT: can't resolve ") + String(mCfg->broker));
+                        setBackoff();
+                    }
+                    break;
 
+                case MQTT_STATE_TCP: {
+                    #if defined(ESP32)
+                        int ok = mEspClient.connect(mBrokerIp, mCfg->port, MQTT_CONNECT_TIMEOUT);
+                    #else
+                        mEspClient.setTimeout(MQTT_CONNECT_TIMEOUT);
+                        int ok = mEspClient.connect(mBrokerIp, mCfg->port);
+                    #endif
+                    if(ok)
+                        setState(MQTT_STATE_CONNECT);
+                    else
+                        setBackoff();
+                    break;
+                }
+
+                case MQTT_STATE_CONNECT: {
+                    // the TCP connection is up, PubSubClient only does the
+                    // MQTT handshake
+                    mClient->setServer(mBrokerIp, mCfg->port);
                     char lwt[MQTT_TOPIC_LEN + 7 ]; // "/uptime" --> + 7 byte
                     snprintf(lwt, MQTT_TOPIC_LEN + 7, "%s/uptime", mCfg->topic);
 
+                    bool ok;
                     if((strlen(mCfg->user) > 0) && (strlen(mCfg->pwd) > 0))
-                        resub = mClient->connect(mDevName, mCfg->user, mCfg->pwd, lwt, 0, false, "offline");
+                        ok = mClient->connect(mDevName, mCfg->user, mCfg->pwd, lwt, 0, false, "offline");
                     else
-                        resub = mClient->connect(mDevName, lwt, 0, false, "offline");
-                        // ein Subscribe ist nur nach einem connect notwendig
-                    if(resub) {
-                        char topic[MQTT_TOPIC_LEN + 13 ]; // "/devcontrol/#" --> + 6 byte
-                        // ToDo: "/devcontrol/#" is hardcoded 
-                        snprintf(topic, MQTT_TOPIC_LEN + 13, "%s/devcontrol/#", mCfg->topic);
-                        DPRINTLN(DBG_INFO, F("subscribe to ") + String(topic));
-                        mClient->subscribe(topic); // subscribe to mTopic + "/devcontrol/#"
+                        ok = mClient->connect(mDevName, lwt, 0, false, "offline");
+                    if(ok)
+                        setState(MQTT_STATE_SUBSCRIBE);
+                    else {
+                        DPRINTLN(DBG_WARN, F("MQTT: connect failed, state ") + String(mClient->state()));
+                        setBackoff();
                     }
+                    break;
                 }
+
+                case MQTT_STATE_SUBSCRIBE: {
+                    char topic[MQTT_TOPIC_LEN + 13 ]; // "/devcontrol/#" --> + 6 byte
+                    // ToDo: "/devcontrol/#" is hardcoded
+                    snprintf(topic, MQTT_TOPIC_LEN + 13, "%s/devcontrol/#", mCfg->topic);
+                    DPRINTLN(DBG_INFO, F("subscribe to ") + String(topic));
+                    if(!mClient->subscribe(topic)) { // subscribe to mTopic + "/devcontrol/#"
+                        setBackoff();
+                        break;
+                    }
+                    setState(MQTT_STATE_CONNECTED);
+                    mBackoff = MQTT_RECONNECT_DELAY;
+                    if(NULL != mVersion)
+                        sendMsg("version", mVersion);
+                    sendMsg("device", mDevName);
+                    break;
+                }
+
+                case MQTT_STATE_CONNECTED:
+                    if(!mClient->connected()) {
+                        DPRINTLN(DBG_INFO, F("MQTT: connection lost, state ") + String(mClient->state()));
+                        setBackoff();
+                    }
+                    else
+                        mClient->loop();
+                    break;
+
+                case MQTT_STATE_BACKOFF:
+                    if((millis() - mStateTs) >= mWait)
+                        setState(MQTT_STATE_DNS);
+                    break;
+
+                default:
+                    break;
             }
         }
 
+        uint32_t getTxCnt(void) {
+            return mTxCnt;
+        }
+
+    private:
+        enum {MQTT_DNS_IDLE = 0, MQTT_DNS_BUSY, MQTT_DNS_DONE, MQTT_DNS_FAILED};
+
+        inline void setState(uint8_t state) {
+            mState   = state;
+            mStateTs = millis();
+        }
+
+        // starts the lookup of the broker, the answer is taken over by
+        // dnsFound() from the context of the network stack
+        void resolve(void) {
+            ip_addr_t addr;
+            mDnsState = MQTT_DNS_BUSY;
+            err_t err = dns_gethostbyname(mCfg->broker, &addr, &mqtt::dnsFound, this);
+            if(ERR_OK == err) { // cached
+                mBrokerIp = IPAddress(ip4_addr_get_u32(ip_2_ip4(&addr)));
+                mDnsState = MQTT_DNS_DONE;
+                setState(MQTT_STATE_TCP);
+            }
+            else if(ERR_INPROGRESS == err)
+                setState(MQTT_STATE_DNS_WAIT);
+            else {
+                mDnsState = MQTT_DNS_FAILED;
+                setBackoff();
+            }
+        }
+
+        static void dnsFound(const char *name, const ip_addr_t *addr, void *arg) {
+            mqtt *p = (mqtt *)arg;
+            if(MQTT_DNS_BUSY != p->mDnsState)
+                return; // timed out
+            if(NULL != addr) {
+                p->mBrokerIp = IPAddress(ip4_addr_get_u32(ip_2_ip4(addr)));
+                p->mDnsState = MQTT_DNS_DONE;
+            }
+            else
+                p->mDnsState = MQTT_DNS_FAILED;
+        }
+
+        // waits a random time between half and the full backoff, which is
+        // doubled with each failed attempt up to MQTT_RECONNECT_DELAY_MAX
+        void setBackoff(void) {
+            mClient->disconnect();
+            mEspClient.stop();
+            mDnsState = MQTT_DNS_IDLE;
+            mWait = (mBackoff / 2) + random(mBackoff / 2 + 1);
+            if(mBackoff < MQTT_RECONNECT_DELAY_MAX)
+                mBackoff = ((mBackoff * 2) > MQTT_RECONNECT_DELAY_MAX) ? MQTT_RECONNECT_DELAY_MAX : (mBackoff * 2);
+            DPRINTLN(DBG_DEBUG, F("MQTT: retry in ") + String(mWait) + F(" ms"));
+            setState(MQTT_STATE_BACKOFF);
+        }
+
         WiFiClient mEspClient;
         PubSubClient *mClient;
-        
-        bool mAddressSet;
+
         mqttConfig_t *mCfg;
         char mDevName[DEVNAME_LEN];
-        uint32_t mLastReconnect;
+        const char *mVersion;
         uint32_t mTxCnt;
+        char mBase[MQTT_TOPIC_LEN + 1]; // <topic>/
+        uint8_t mBaseLen;
+
+        uint8_t mState;
+        uint32_t mStateTs;  // [ms] time the current state was entered
+        uint32_t mBackoff;  // [ms] current maximum wait time
+        uint32_t mWait;     // [ms] wait time of the current backoff
+        volatile uint8_t mDnsState;
+        IPAddress mBrokerIp;
 };
 
 #endif /*__MQTT_H_*/
@@ -0,0 +1,253 @@
+//-----------------------------------------------------------------------------
+// 2022 Ahoy, https://github.com/lumpapu/ahoy
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __MQTT_OUTBOX_H__
+#define __MQTT_OUTBOX_H__
+
+#include <LittleFS.h>
+
+#define OUTBOX_INDEX        "/outbox.idx"
+#define OUTBOX_SEGMENT      "/ob%08x"   // segment files, numbered
+#define OUTBOX_NAME_LEN     16
+#define OUTBOX_MAGIC        0x41484f32
+#define OUTBOX_BATCH        16          // entries written to / read from flash at once
+#define OUTBOX_SEG_SIZE     4096        // [byte] per segment file, one flash block
+
+/**
+ * Entries which couldn't be sent, kept in numbered segment files.
+ * New entries are collected in RAM and appended as one batch to the newest
+ * segment, a file is never rewritten, so only its last block is copied by
+ * LittleFS. Entries are read back in batches and a segment is deleted once
+ * it was handed out completely. The small index file (first and next
+ * segment number) is only written if a segment is created or deleted.
+ * The oldest segment is dropped if the space of SIZE, at most a quarter of
+ * the file system, is used.
+ * The read position inside of a segment is kept in RAM, its entries may be
+ * handed out twice after a reboot, they are never lost otherwise.
+ */
+template <class ENTRY, uint32_t SIZE>
+class MqttOutbox {
+    public:
+        MqttOutbox() {
+            mValid    = false;
+            mFirst    = 0;
+            mNext     = 0;
+            mMaxSeg   = 0;
+            mWrCnt    = 0;
+            mRdOff    = 0;
+            mFlashCnt = 0;
+            mRamCnt   = 0;
+            mRdCnt    = 0;
+            mRdPos    = 0;
+        }
+        ~MqttOutbox() {}
+
+        void setup(void) {
+            #if defined(ESP32)
+                if(!LittleFS.begin(true))
+            #else
+                if(!LittleFS.begin())
+            #endif
+            {
+                DPRINTLN(DBG_WARN, F("outbox: LittleFS not available"));
+                return;
+            }
+
+            uint32_t size = getFsSize() / 4;
+            if(size > SIZE)
+                size = SIZE;
+            mMaxSeg = size / OUTBOX_SEG_SIZE;
+            if(mMaxSeg < 2) {
+                DPRINTLN(DBG_WARN, F("outbox: file system too small"));
+                return;
+            }
+
+            idx_t idx;
+            File f = LittleFS.open(OUTBOX_INDEX, "r");
+            if(f) {
+                bool ok = (f.read((uint8_t *)&idx, sizeof(idx_t)) == sizeof(idx_t)) && (OUTBOX_MAGIC == idx.magic);
+                if(ok && ((idx.next - idx.first) <= (4 * mMaxSeg))) {
+                    mFirst = idx.first;
+                    mNext  = idx.next;
+                }
+                f.close();
+            }
+            mValid = true;
+
+            for(uint32_t seg = mFirst; seg != mNext; seg++) {
+                mWrCnt = getSegCnt(seg);
+                mFlashCnt += mWrCnt;
+            }
+            while((mNext - mFirst) > mMaxSeg)
+                drop();
+            if(0 != mFlashCnt)
+                DPRINTLN(DBG_INFO, F("outbox: ") + String(mFlashCnt) + F(" entries to send"));
+        }
+
+        void add(const ENTRY *e) {
+            mRam[mRamCnt++] = *e;
+            if(OUTBOX_BATCH == mRamCnt)
+                flush();
+        }
+
+        // next entry to send, false if there is none
+        bool peek(ENTRY *e) {
+            if(mRdPos >= mRdCnt) {
+                mRdCnt = 0;
+                mRdPos = 0;
+                if(mValid)
+                    load();
+                if((0 == mRdCnt) && (0 != mRamCnt)) { // not written to flash yet
+                    memcpy(mRd, mRam, mRamCnt * sizeof(ENTRY));
+                    mRdCnt  = mRamCnt;
+                    mRamCnt = 0;
+                }
+                if(mRdPos >= mRdCnt)
+                    return false;
+            }
+            *e = mRd[mRdPos];
+            return true;
+        }
+
+        // the entry of peek() was sent
+        inline void pop(void) {
+            if(mRdPos < mRdCnt)
+                mRdPos++;
+        }
+
+        uint32_t getCnt(void) {
+            return mFlashCnt + mRamCnt + (mRdCnt - mRdPos);
+        }
+
+    private:
+        typedef struct {
+            uint32_t magic;
+            uint32_t first; // oldest segment
+            uint32_t next;  // number of the next new segment
+        } idx_t;
+
+        static const uint32_t SEG_ENTRIES = OUTBOX_SEG_SIZE / sizeof(ENTRY);
+        static_assert((OUTBOX_SEG_SIZE / sizeof(ENTRY)) >= OUTBOX_BATCH, "outbox segment too small");
+
+        // appends the entries collected in RAM as one batch
+        void flush(void) {
+            if(!mValid) {
+                mRamCnt = 0; // dropped, no flash
+                return;
+            }
+            bool newSeg = (mFirst == mNext) || ((mWrCnt + mRamCnt) > SEG_ENTRIES);
+            if(newSeg) {
+                if((mNext - mFirst) >= mMaxSeg)
+                    drop();
+                mNext++;
+                mWrCnt = 0;
+                writeIndex();
+            }
+
+            char name[OUTBOX_NAME_LEN];
+            getSegName(name, mNext - 1);
+            File f = LittleFS.open(name, newSeg ? "w" : "a");
+            if(f) {
+                uint32_t len = f.write((uint8_t *)mRam, mRamCnt * sizeof(ENTRY)) / sizeof(ENTRY);
+                f.close();
+                mWrCnt    += len;
+                mFlashCnt += len;
+            }
+            mRamCnt = 0;
+        }
+
+        // reads the next batch of the oldest segment, segments which were
+        // handed out completely are deleted
+        void load(void) {
+            char name[OUTBOX_NAME_LEN];
+            while(mFirst != mNext) {
+                getSegName(name, mFirst);
+                File f = LittleFS.open(name, "r");
+                if(f) {
+                    uint32_t cnt = f.size() / sizeof(ENTRY);
+                    if(mRdOff < cnt) {
+                        uint32_t n = ((cnt - mRdOff) > OUTBOX_BATCH) ? OUTBOX_BATCH : (cnt - mRdOff);
+                        f.seek(mRdOff * sizeof(ENTRY));
+                        if(f.read((uint8_t *)mRd, n * sizeof(ENTRY)) == (n * sizeof(ENTRY))) {
+                            f.close();
+                            mRdCnt     = n;
+                            mRdOff    += n;
+                            mFlashCnt -= n;
+                            return;
+                        }
+                    }
+                    f.close();
+                }
+                drop();
+            }
+        }
+
+        // deletes the oldest segment
+        void drop(void) {
+            char name[OUTBOX_NAME_LEN];
+            uint32_t cnt = getSegCnt(mFirst);
+            if(cnt > mRdOff)
+                mFlashCnt -= (cnt - mRdOff);
+            getSegName(name, mFirst);
+            LittleFS.remove(name);
+            mFirst++;
+            mRdOff = 0;
+            if(mFirst == mNext)
+                mWrCnt = 0;
+            writeIndex();
+        }
+
+        void writeIndex(void) {
+            idx_t idx;
+            idx.magic = OUTBOX_MAGIC;
+            idx.first = mFirst;
+            idx.next  = mNext;
+            File f = LittleFS.open(OUTBOX_INDEX, "w");
+            if(f) {
+                f.write((uint8_t *)&idx, sizeof(idx_t));
+                f.close();
+            }
+        }
+
+        uint32_t getSegCnt(uint32_t seg) {
+            char name[OUTBOX_NAME_LEN];
+            getSegName(name, seg);
+            File f = LittleFS.open(name, "r");
+            if(!f)
+                return 0;
+            uint32_t cnt = f.size() / sizeof(ENTRY);
+            f.close();
+            return cnt;
+        }
+
+        inline void getSegName(char name[], uint32_t seg) {
+            snprintf(name, OUTBOX_NAME_LEN, OUTBOX_SEGMENT, (unsigned int)seg);
+        }
+
+        uint32_t getFsSize(void) {
+            #if defined(ESP32)
+                return LittleFS.totalBytes();
+            #else
+                FSInfo info;
+                if(!LittleFS.info(info))
+                    return 0;
+                return info.totalBytes;
+            #endif
+        }
+
+        bool mValid;
+        uint32_t mFirst, mNext;     // segments in flash: mFirst ... mNext - 1
+        uint32_t mMaxSeg;
+        uint32_t mWrCnt;            // entries of the newest segment
+        uint32_t mRdOff;            // entries of the oldest segment handed out
+        uint32_t mFlashCnt;         // entries in flash not handed out yet
+        ENTRY mRam[OUTBOX_BATCH];   // new entries, not written yet
+        uint8_t mRamCnt;
+        ENTRY mRd[OUTBOX_BATCH];    // entries being sent
+        uint8_t mRdCnt;
+        uint8_t mRdPos;
+};
+
+#endif /*__MQTT_OUTBOX_H__*/
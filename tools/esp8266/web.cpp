@@ -242,12 +242,21 @@ void web::showSave(AsyncWebServerRequest *request) {
         // inverter
         Inverter<> *iv;
         for(uint8_t i = 0; i < MAX_NUM_INVERTERS; i ++) {
-            iv = mMain->mSys->getInverterByPos(i, false);
             // address
             request->arg("inv" + String(i) + "Addr").toCharArray(buf, 20);
             if(strlen(buf) == 0)
                 memset(buf, 0, 20);
-            iv->serial.u64 = mMain->Serial2u64(buf);
+            uint64_t serial = mMain->Serial2u64(buf);
+
+            // inverter objects exist for configured slots only, a new one
+            // is allocated here and becomes active after a reboot
+            iv = mMain->mSys->getInverterByPos(i, false);
+            if(NULL == iv) {
+                if(0ULL == serial)
+                    continue;
+                iv = mMain->mSys->getSlot(i);
+            }
+            iv->serial.u64 = serial;
             switch(iv->serial.b[4]) {
                 case 0x21: iv->type = INV_TYPE_1CH; iv->channels = 1; break;
                 case 0x41: iv->type = INV_TYPE_2CH; iv->channels = 2; break;
@@ -263,8 +272,11 @@ void web::showSave(AsyncWebServerRequest *request) {
                 iv->chMaxPwr[j] = request->arg("inv" + String(i) + "ModPwr" + String(j)).toInt() & 0xffff;
                 request->arg("inv" + String(i) + "ModName" + String(j)).toCharArray(iv->chName[j], MAX_NAME_LENGTH);
             }
-            iv->initialized = true;
+            iv->invalidateCalc();
+            // a slot allocated here stays uninitialized (no records) until
+            // it is added with the next boot, see HmSystem::isActive()
         }
+        mMain->mSys->rebuildIndex();
         if(request->arg("invInterval") != "")
             mConfig->sendInterval = request->arg("invInterval").toInt();
         if(request->arg("invRetry") != "")
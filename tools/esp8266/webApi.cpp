@@ -43,20 +43,21 @@ void webApi::onApi(AsyncWebServerRequest *request) {
     AsyncJsonResponse* response = new AsyncJsonResponse(false, 8192);
     JsonObject root = response->getRoot();
 
-    Inverter<> *iv = mApp->mSys->getInverterByPos(0, false);
     String path = request->url().substring(5);
     if(path == "system")              getSystem(root);
     else if(path == "statistics")     getStatistics(root);
+    else if(path == "link")           getLink(root);
     else if(path == "inverter/list")  getInverterList(root);
     else if(path == "menu")           getMenu(root);
     else if(path == "index")          getIndex(root);
     else if(path == "setup")          getSetup(root);
     else if(path == "setup/networks") getNetworks(root);
     else if(path == "live")           getLive(root);
-    else if(path == "record/info")    getRecord(root, iv->getRecordStruct(InverterDevInform_All));
-    else if(path == "record/alarm")   getRecord(root, iv->getRecordStruct(AlarmData));
-    else if(path == "record/config")  getRecord(root, iv->getRecordStruct(SystemConfigPara));
-    else if(path == "record/live")    getRecord(root, iv->getRecordStruct(RealTimeRunData_Debug));
+    else if(path == "history")        getHistory(root, request);
+    else if(path == "record/info")    getRecord(root, InverterDevInform_All);
+    else if(path == "record/alarm")   getRecord(root, AlarmData);
+    else if(path == "record/config")  getRecord(root, SystemConfigPara);
+    else if(path == "record/live")    getRecord(root, RealTimeRunData_Debug);
     else
         getNotFound(root, F("http://") + request->host() + F("/api/"));
 
@@ -112,10 +113,12 @@ void webApi::getNotFound(JsonObject obj, String url) {
     JsonObject ep = obj.createNestedObject("avail_endpoints");
     ep[F("system")]        = url + F("system");
     ep[F("statistics")]    = url + F("statistics");
+    ep[F("link")]          = url + F("link");
     ep[F("inverter/list")] = url + F("inverter/list");
     ep[F("index")]         = url + F("index");
     ep[F("setup")]         = url + F("setup");
     ep[F("live")]          = url + F("live");
+    ep[F("history")]       = url + F("history?iv=0&fld=P_AC&from=0&to=0&buckets=48");
     ep[F("record/info")]   = url + F("record/info");
     ep[F("record/alarm")]  = url + F("record/alarm");
     ep[F("record/config")] = url + F("record/config");
@@ -166,6 +169,54 @@ void webApi::getStatistics(JsonObject obj) {
     obj[F("rx_fail_answer")] = mStat->rxFailNoAnser;
     obj[F("frame_cnt")]      = mStat->frmCnt;
     obj[F("tx_cnt")]         = mApp->mSys->Radio.mSendCnt;
+    obj[F("spi_bytes")]      = mStat->spiBytes;
+    obj[F("buf_overflow")]   = mApp->mSys->BufCtrl.getOverflowCnt();
+    obj[F("buf_high_water")] = mApp->mSys->BufCtrl.getHighWater();
+    obj[F("dup_dropped")]    = mApp->mSys->Dedup.getDropCnt();
+#if (NUM_RX_RADIOS > 0)
+    JsonArray rxRadios = obj.createNestedArray(F("rx_radios"));
+    for(uint8_t i = 0; i < NUM_RX_RADIOS; i++) {
+        JsonObject rxObj = rxRadios.createNestedObject();
+        rxObj[F("ch")]     = mApp->mSys->RxRadio[i].getChannel();
+        rxObj[F("rx_cnt")] = mApp->mSys->RxRadio[i].mRxCnt;
+    }
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+void webApi::getLink(JsonObject obj) {
+    JsonArray invArr = obj.createNestedArray(F("inverter"));
+    for(uint8_t i = 0; i < mApp->mSys->getNumInverters(); i++) {
+        Inverter<> *iv = mApp->mSys->getInverterByPos(i);
+        if(NULL == iv)
+            continue;
+        ivLinkStat_t *link = mApp->getIvLinkStat(iv->id);
+        JsonObject obj2 = invArr.createNestedObject();
+        obj2[F("id")]          = i;
+        obj2[F("name")]        = String(iv->name);
+        obj2[F("frames")]      = link->frmCnt;
+        obj2[F("crc_fail")]    = link->crcFail;
+        obj2[F("dup")]         = link->dupCnt;
+        obj2[F("missing")]     = link->missing;
+        obj2[F("retransmits")] = link->retransmits;
+        obj2[F("rtt")]         = link->rtt;
+        obj2[F("rtt_avg")]     = link->rttAvg;
+    }
+
+    JsonArray chArr = obj.createNestedArray(F("channel"));
+    for(uint8_t i = 0; i < RF_CHANNELS; i++) {
+        chLinkStat_t *link = mApp->getChLinkStat(i);
+        uint32_t rpd, samples;
+        mApp->mSys->Radio.getRpd(i, &rpd, &samples);
+        JsonObject obj2 = chArr.createNestedObject();
+        obj2[F("ch")]          = mApp->mSys->Radio.getRfChannel(i);
+        obj2[F("frames")]      = link->frmCnt;
+        obj2[F("crc_fail")]    = link->crcFail;
+        obj2[F("dup")]         = link->dupCnt;
+        obj2[F("rpd")]         = rpd;
+        obj2[F("rpd_samples")] = samples;
+    }
 }
 
 
@@ -271,10 +322,13 @@ void webApi::getIndex(JsonObject obj) {
 
     JsonArray inv = obj.createNestedArray(F("inverter"));
     Inverter<> *iv;
+    recSnapshot_t<> snap;
     for(uint8_t i = 0; i < MAX_NUM_INVERTERS; i ++) {
         iv = mApp->mSys->getInverterByPos(i);
         if(NULL != iv) {
-            record_t<> *rec = iv->getRecordStruct(RealTimeRunData_Debug);
+            // the entry is kept if the payload is being written (empty record)
+            iv->getSnapshot(iv->getRecordStruct(RealTimeRunData_Debug), &snap);
+            record_t<> *rec = &snap.rec;
             JsonObject invObj = inv.createNestedObject();
             invObj[F("id")]              = i;
             invObj[F("name")]            = String(iv->name);
@@ -288,6 +342,12 @@ void webApi::getIndex(JsonObject obj) {
     JsonArray warn = obj.createNestedArray(F("warnings"));
     if(!mApp->mSys->Radio.isChipConnected())
         warn.add(F("your NRF24 module can't be reached, check the wiring and pinout"));
+#if (NUM_RX_RADIOS > 0)
+    for(uint8_t i = 0; i < NUM_RX_RADIOS; i++) {
+        if(!mApp->mSys->RxRadio[i].isChipConnected())
+            warn.add(F("additional NRF24 RX module #") + String(i) + F(" can't be reached"));
+    }
+#endif
     if(!mApp->mqttIsConnected())
         warn.add(F("MQTT is not connected"));
 
@@ -332,10 +392,14 @@ void webApi::getLive(JsonObject obj) {
 
     Inverter<> *iv;
     uint8_t pos;
+    recSnapshot_t<> snap;
     for(uint8_t i = 0; i < MAX_NUM_INVERTERS; i ++) {
         iv = mApp->mSys->getInverterByPos(i);
         if(NULL != iv) {
-            record_t<> *rec = iv->getRecordStruct(RealTimeRunData_Debug);
+            // the entry is kept if the payload is being written (empty record),
+            // the inverters are identified by their position
+            iv->getSnapshot(iv->getRecordStruct(RealTimeRunData_Debug), &snap);
+            record_t<> *rec = &snap.rec;
             JsonObject obj2 = invArr.createNestedObject();
             obj2[F("name")]               = String(iv->name);
             obj2[F("channels")]           = iv->channels;
@@ -348,7 +412,7 @@ void webApi::getLive(JsonObject obj) {
             obj2[F("ch_names")][0] = "AC";
             for (uint8_t fld = 0; fld < sizeof(list); fld++) {
                 pos = (iv->getPosByChFld(CH0, list[fld], rec));
-                ch0[fld] = (0xff != pos) ? round3(iv->getValue(pos, rec)) : 0.0;
+                ch0[fld] = recVal(iv, pos, rec);
                 obj[F("ch0_fld_units")][fld] = (0xff != pos) ? String(iv->getUnit(pos, rec)) : notAvail;
                 obj[F("ch0_fld_names")][fld] = (0xff != pos) ? String(iv->getFieldName(pos, rec)) : notAvail;
             }
@@ -365,7 +429,7 @@ void webApi::getLive(JsonObject obj) {
                         case 4:  pos = (iv->getPosByChFld(j, FLD_YT, rec));  break;
                         case 5:  pos = (iv->getPosByChFld(j, FLD_IRR, rec)); break;
                     }
-                    cur[k] = (0xff != pos) ? round3(iv->getValue(pos, rec)) : 0.0;
+                    cur[k] = recVal(iv, pos, rec);
                     if(1 == j) {
                         obj[F("fld_units")][k] = (0xff != pos) ? String(iv->getUnit(pos, rec)) : notAvail;
                         obj[F("fld_names")][k] = (0xff != pos) ? String(iv->getFieldName(pos, rec)) : notAvail;
@@ -378,21 +442,141 @@ void webApi::getLive(JsonObject obj) {
 
 
 //-----------------------------------------------------------------------------
-void webApi::getRecord(JsonObject obj, record_t<> *rec) {
+void webApi::getHistory(JsonObject obj, AsyncWebServerRequest *request) {
+#if (HISTORY_SIZE > 0)
+    uint8_t fld = historyFields[0];
+    for(uint8_t i = 0; i < HISTORY_FLD_CNT; i++) {
+        obj[F("fields")][i] = fields[historyFields[i]];
+        if(request->arg("fld") == fields[historyFields[i]])
+            fld = historyFields[i];
+    }
+
+    Inverter<> *iv = mApp->mSys->getInverterByPos(request->arg("iv").toInt());
+    if(NULL == iv) {
+        obj[F("error")] = F("inverter not found");
+        return;
+    }
+    HistoryType *hist = mApp->getHistory(iv->id, fld);
+    record_t<> *rec = iv->getRecordStruct(RealTimeRunData_Debug);
+    uint8_t pos = iv->getPosByChFld(CH0, fld, rec);
+    if((NULL == hist) || (0xff == pos)) {
+        obj[F("error")] = F("field not recorded");
+        return;
+    }
+
+    uint32_t from = request->arg("from").toInt();
+    uint32_t to   = request->arg("to").toInt();
+    int buckets   = request->arg("buckets").toInt();
+    if(0 == from)
+        from = hist->getFirstTs();
+    if(0 == to)
+        to = hist->getLastTs();
+    if((buckets <= 0) || (buckets > HISTORY_MAX_BUCKETS))
+        buckets = (buckets <= 0) ? 48 : HISTORY_MAX_BUCKETS;
+    uint32_t step = ((to > from) ? (to - from) : 0) / buckets + 1;
+    uint16_t scale = iv->getScale(pos, rec);
+
+    obj[F("name")] = String(iv->name);
+    obj[F("fld")]  = fields[fld];
+    obj[F("unit")] = String(iv->getUnit(pos, rec));
+    obj[F("from")] = from;
+    obj[F("to")]   = to;
+    obj[F("step")] = step;
+    JsonArray tsArr  = obj.createNestedArray(F("ts"));
+    JsonArray minArr = obj.createNestedArray(F("min"));
+    JsonArray maxArr = obj.createNestedArray(F("max"));
+    JsonArray avgArr = obj.createNestedArray(F("avg"));
+
+    // a sample is valid until the next one (only changes are recorded), the
+    // series is a step function: each bucket starts with the value carried in
+    // from before it, avg is weighted by the time a value was valid. Buckets
+    // before the first sample are left out, the last one lasts until 'to'
+    uint32_t end = to + 1;
+    int32_t bMin = 0, bMax = 0;
+    int64_t bSum = 0;
+    uint32_t bDur = 0;
+    uint32_t bIdx = 0;
+    bool bUsed = false;
+    auto addBucket = [&]() {
+        if(!bUsed)
+            return;
+        tsArr.add(from + bIdx * step);
+        minArr.add((double)bMin / scale);
+        maxArr.add((double)bMax / scale);
+        avgArr.add(round3((double)bSum / bDur / scale));
+        bUsed = false;
+    };
+    // value val from s until e (exclusive), split to the buckets
+    auto addSpan = [&](uint32_t s, uint32_t e, int32_t val) {
+        if(s < from)
+            s = from;
+        if(e > end)
+            e = end;
+        while(s < e) {
+            uint32_t idx = (s - from) / step;
+            if(idx != bIdx) {
+                addBucket();
+                bIdx = idx;
+            }
+            uint32_t bEnd = from + (idx + 1) * step;
+            uint32_t dur = ((bEnd < e) ? bEnd : e) - s;
+            if(!bUsed) {
+                bMin = bMax = val;
+                bSum = 0;
+                bDur = 0;
+                bUsed = true;
+            }
+            if(val < bMin) bMin = val;
+            if(val > bMax) bMax = val;
+            bSum += (int64_t)val * dur;
+            bDur += dur;
+            s += dur;
+        }
+    };
+    bool valid = false;
+    uint32_t lastTs = 0;
+    int32_t lastVal = 0;
+    hist->forEach([&](uint32_t t, int32_t val) {
+        if(valid && (t > lastTs))
+            addSpan(lastTs, t, lastVal);
+        valid   = true;
+        lastTs  = t;
+        lastVal = val;
+    });
+    if(valid)
+        addSpan(lastTs, end, lastVal);
+    addBucket();
+#else
+    obj[F("error")] = F("history disabled, see HISTORY_SIZE");
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+void webApi::getRecord(JsonObject obj, uint8_t recType) {
     JsonArray invArr = obj.createNestedArray(F("inverter"));
 
     Inverter<> *iv;
     uint8_t pos;
+    char val[16];
+    recSnapshot_t<> snap;
     for(uint8_t i = 0; i < MAX_NUM_INVERTERS; i ++) {
         iv = mApp->mSys->getInverterByPos(i);
         if(NULL != iv) {
+            iv->getSnapshot(iv->getRecordStruct(recType), &snap); // empty while written
+            record_t<> *rec = &snap.rec;
             JsonArray obj2 = invArr.createNestedArray();
             for(uint8_t j = 0; j < rec->length; j++) {
                 byteAssign_t *assign = iv->getByteAssign(j, rec);
                 pos = (iv->getPosByChFld(assign->ch, assign->fieldId, rec));
                 obj2[j]["fld"]  = (0xff != pos) ? String(iv->getFieldName(pos, rec)) : notAvail;
                 obj2[j]["unit"] = (0xff != pos) ? String(iv->getUnit(pos, rec)) : notAvail;
-                obj2[j]["val"]  = (0xff != pos) ? String(iv->getValue(pos, rec)) : notAvail;
+                if(0xff != pos) {
+                    iv->getValueStr(pos, rec, val, 16);
+                    obj2[j]["val"] = String(val);
+                }
+                else
+                    obj2[j]["val"] = notAvail;
             }
         }
     }
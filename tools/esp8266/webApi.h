@@ -12,6 +12,8 @@
 #include "app.h"
 
 
+#define HISTORY_MAX_BUCKETS     96
+
 class app;
 
 class webApi {
@@ -34,6 +36,7 @@ class webApi {
 
         void getSystem(JsonObject obj);
         void getStatistics(JsonObject obj);
+        void getLink(JsonObject obj);
         void getInverterList(JsonObject obj);
         void getMqtt(JsonObject obj);
         void getNtp(JsonObject obj);
@@ -47,7 +50,8 @@ class webApi {
         void getSetup(JsonObject obj);
         void getNetworks(JsonObject obj);
         void getLive(JsonObject obj);
-        void getRecord(JsonObject obj, record_t<> *rec);
+        void getHistory(JsonObject obj, AsyncWebServerRequest *request);
+        void getRecord(JsonObject obj, uint8_t recType);
 
         bool setCtrl(DynamicJsonDocument jsonIn, JsonObject jsonOut);
         bool setSetup(DynamicJsonDocument jsonIn, JsonObject jsonOut);
@@ -58,6 +62,20 @@ class webApi {
            return (int)(value * 1000 + 0.5) / 1000.0;
         }
 
+        // record value as JSON number, integers are scaled by their divisor
+#if defined(REC_FIXED_POINT)
+        SerializedValue<String> recVal(Inverter<> *iv, uint8_t pos, record_t<> *rec) {
+            char val[16] = "0";
+            if(0xff != pos)
+                iv->getValueStr(pos, rec, val, 16);
+            return serialized(String(val));
+        }
+#else
+        double recVal(Inverter<> *iv, uint8_t pos, record_t<> *rec) {
+            return (0xff != pos) ? round3(iv->getValue(pos, rec)) : 0.0;
+        }
+#endif
+
         AsyncWebServer *mSrv;
         app *mApp;
 